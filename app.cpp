@@ -34,9 +34,9 @@ SOFTWARE.
 #include "./network.h"
 #include "./pwmtimer.h"
 #include "./random.h"
-#include "./sacn.h"
 #include "./settingsdb.h"
 #include "./systick.h"
+#include "./timerwheel.h"
 #include "./utils.h"
 #include "./webserver.h"
 #include "stm32h5xx_hal.h"
@@ -141,13 +141,14 @@ void App::start() {
     }
 
 #ifndef BOOTLOADER
-    sACNPacket::joinNetworks();
-
-    Model::instance().applyToControl();
+    // Routes, strip setup and IGMP joins are applied by the ingest thread, the only writer of the strip buffers
+    Network::instance().scheduleReconfigure();
 
     if (!Control::instance().start()) {
         return;
     }
+
+    TimerWheel::instance().start();
 #endif  // #ifndef BOOTLOADER
 
     printf(ESCAPE_FG_CYAN "App up.\n");
@@ -169,6 +170,8 @@ void App::setup(void *first_unused_memory) {
 
 #ifndef BOOTLOADER
     pointer = Control::instance().setup(pointer);
+
+    pointer = TimerWheel::instance().setup(pointer);
 #endif  // #ifndef BOOTLOADER
 
     printf(ESCAPE_FG_CYAN "Consumed %d bytes of RAM.\n" ESCAPE_RESET, (int)(pointer - (uint8_t *)first_unused_memory));
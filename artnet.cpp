@@ -31,7 +31,10 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "./app.h"
 #include "./control.h"
+#include "./merge.h"
 #include "./network.h"
+#include "./random.h"
+#include "./sequence.h"
 #include "./settingsdb.h"
 #include "./systick.h"
 #include "version.h"
@@ -39,12 +42,129 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #ifndef BOOTLOADER
 
 static ArtSyncWatchDog syncWatchDog;
+static SequenceTracker sequenceTracker(4000);
 
-void ArtSyncWatchDog::feed() { fedtime = Systick::instance().systemTime(); }
+static uint32_t sourceAddress(const NXD_ADDRESS *from) {
+    if (from->nxd_ip_version == NX_IP_VERSION_V6) {
+        return uint32_t(from->nxd_ip_address.v6[0] ^ from->nxd_ip_address.v6[1] ^ from->nxd_ip_address.v6[2] ^ from->nxd_ip_address.v6[3]);
+    }
+    return uint32_t(from->nxd_ip_address.v4);
+}
+
+static bool acceptSequence(uint32_t source, uint16_t universe, uint8_t sequence) {
+    // Art-Net sequence 0 means the sender does not track sequence numbers
+    if (sequence == 0) {
+        return true;
+    }
+    return sequenceTracker.check(universe, source, sequence) == SequenceTracker::Accept;
+}
+
+// Art-Net 4 merging: a universe follows at most two senders, a third one is ignored until either of them has been
+// silent for the merge timeout. LTP, or a single sender, passes the packet straight through.
+class ArtMerge {
+   public:
+    const uint8_t *arbitrate(uint32_t source, uint16_t universe, const uint8_t *data, size_t &len);
+
+   private:
+    static constexpr size_t portN = 32;
+    static constexpr size_t slotN = 512;
+    static constexpr uint32_t mergeTimeoutMs = 10000;
+
+    struct Port {
+        uint64_t seen[2];
+        uint32_t source[2];
+        uint16_t len[2];
+        uint16_t universe;
+        bool live[2];
+        bool stored[2];
+        alignas(4) std::array<uint8_t, slotN> levels[2];
+    };
+
+    std::array<Port, portN> ports{};
+    alignas(4) std::array<uint8_t, slotN> merged{};
+};
+
+static ArtMerge artMerge;
+
+const uint8_t *ArtMerge::arbitrate(uint32_t source, uint16_t universe, const uint8_t *data, size_t &len) {
+    const uint64_t now = Systick::instance().systemTimeRAW();
+    const uint64_t timeout = Systick::msToCycles(mergeTimeoutMs);
+    len = std::min(len, slotN);
+
+    Port *port = nullptr;
+    Port *unused = nullptr;
+    for (Port &p : ports) {
+        for (size_t c = 0; c < 2; c++) {
+            if (p.live[c] && Systick::elapsed(now, p.seen[c], timeout)) {
+                p.live[c] = false;
+            }
+        }
+        if (!p.live[0] && !p.live[1]) {
+            if (!unused) {
+                unused = &p;
+            }
+            continue;
+        }
+        if (p.universe == universe) {
+            port = &p;
+            break;
+        }
+    }
+
+    if (!port) {
+        if (!unused) {
+            return data;
+        }
+        port = unused;
+        port->universe = universe;
+    }
+
+    size_t self = port->live[0] && port->source[0] == source ? 0 : port->live[1] && port->source[1] == source ? 1 : 2;
+    if (self == 2) {
+        self = !port->live[0] ? 0 : !port->live[1] ? 1 : 2;
+        if (self == 2) {
+            return nullptr;
+        }
+        port->source[self] = source;
+        port->len[self] = slotN;
+        port->live[self] = true;
+        port->stored[self] = false;
+    }
+    port->seen[self] = now;
+
+    const size_t other = self ^ 1;
+    if (!port->live[other] || Model::instance().mergeLTP) {
+        port->stored[self] = false;
+        return data;
+    }
+
+    // Keep the last frame up until the other sender has one on file
+    uint8_t *levels = port->levels[self].data();
+    if (!port->stored[other]) {
+        memcpy(levels, data, len);
+    } else {
+        Merge::htp(merged.data(), levels, data, port->levels[other].data(), len);
+    }
+    if (len < port->len[self]) {
+        memset(levels + len, 0, port->len[self] - len);
+    }
+    port->len[self] = uint16_t(len);
+    port->stored[self] = true;
+    if (!port->stored[other]) {
+        return nullptr;
+    }
+
+    const size_t merged_len = std::max(len, size_t(port->len[other]));
+    memcpy(merged.data() + len, port->levels[other].data() + len, merged_len - len);
+    len = merged_len;
+    return merged.data();
+}
+
+void ArtSyncWatchDog::feed() { fedtime = Systick::instance().systemTimeRAW(); }
 
 bool ArtSyncWatchDog::starved() {
-    double now = Systick::instance().systemTime();
-    if (fedtime == 0 || ((now - fedtime) > ArtSyncTimeout)) {
+    const uint64_t now = Systick::instance().systemTimeRAW();
+    if (fedtime == 0 || Systick::elapsed(now, fedtime, Systick::msToCycles(ArtSyncTimeoutMs))) {
         fedtime = 0;
         return true;
     }
@@ -86,9 +206,11 @@ int ArtNetPacket::version() const { return static_cast<int>((packet[10] << 8) |
 ArtNetPacket::Opcode ArtNetPacket::opcode() const { return static_cast<Opcode>((packet[8]) | (packet[9] << 8)); }
 
 ArtNetPacket::Opcode ArtNetPacket::maybeValid(const uint8_t *buf, size_t len) {
-    bool bufValid = buf ? true : false;
+    if (!buf || len < 12) {
+        return OpInvalid;
+    }
 
-    bool sizeValid = len <= sizeof(packet);
+    bool sizeValid = len <= maxPacketSize;
 
     bool validSignature = memcmp(buf, "Art-Net", 8) == 0;
 
@@ -140,7 +262,7 @@ ArtNetPacket::Opcode ArtNetPacket::maybeValid(const uint8_t *buf, size_t len) {
 
     bool versionValid = static_cast<int>((buf[10] << 8) | (buf[11])) >= currentVersion;
 
-    return (bufValid && sizeValid && validSignature && opcodeValid && versionValid) ? op : OpInvalid;
+    return (sizeValid && validSignature && opcodeValid && versionValid) ? op : OpInvalid;
 }
 
 bool ArtNetPacket::verify(ArtNetPacket &packet, const uint8_t *buf, size_t len) {  // cppcheck-suppress constParameterReference
@@ -148,7 +270,7 @@ bool ArtNetPacket::verify(ArtNetPacket &packet, const uint8_t *buf, size_t len)
     if (op == OpInvalid) {
         return false;
     }
-    memcpy(packet.packet.data(), buf, std::min(len, packet.packet.size()));
+    packet.packet = std::span<const uint8_t>(buf, len);
     switch (op) {
         case OpPoll:
         case OpSync:
@@ -165,53 +287,83 @@ bool ArtNetPacket::verify(ArtNetPacket &packet, const uint8_t *buf, size_t len)
 
 static constexpr uint32_t syncTimeout = 4;
 
-void ArtNetPacket::sendArtPollReply(const NXD_ADDRESS *from, uint16_t universe) {
-    struct ArtPollReply {
-        uint8_t artNet[8];
-        uint16_t opCode;
-        uint8_t ipAddress[4];
-        uint16_t portNumber;
-        uint16_t versionInfo;
-        uint8_t netSwitch;
-        uint8_t subSwitch;
-        uint16_t oem;
-        uint8_t uebaVersion;
-        uint8_t status1;
-        uint16_t estaManufactor;
-        uint8_t shortName[18];
-        uint8_t longName[64];
-        uint8_t nodeReport[64];
-        uint16_t numPorts;
-        uint8_t portTypes[4];
-        uint8_t goodInput[4];
-        uint8_t goodOutput[4];
-        uint8_t swIn[4];
-        uint8_t swOut[4];
-        uint8_t swVideo;
-        uint8_t swMacro;
-        uint8_t swRemote;
-        uint8_t spare1;
-        uint8_t spare2;
-        uint8_t spare3;
-        uint8_t style;
-        uint8_t macAddress[6];
-        uint8_t bindIp[4];
-        uint8_t bindIndex;
-        uint8_t status2;
-        uint8_t filler[26];
-    } __attribute__((packed)) reply;
+ArtPollResponder &ArtPollResponder::instance() {
+    static ArtPollResponder responder;
+    if (!responder.initialized) {
+        responder.initialized = true;
+        responder.init();
+    }
+    return responder;
+}
+
+void ArtPollResponder::init() { tx_queue_create(&request_queue, const_cast<CHAR *>("artpoll"), TX_8_ULONG, request_storage, sizeof(request_storage)); }
+
+void ArtPollResponder::schedule(const NXD_ADDRESS *from) {
+    Request request{};
+    request.from = *from;
+    // A full queue already has a reply round pending
+    tx_queue_send(&request_queue, &request, TX_NO_WAIT);
+    // Random hold-off so a rig of nodes does not answer a broadcast poll all at once; polls arriving meanwhile share the round
+    TimerWheel::instance().arm(timer, uint32_t(PseudoRandom::instance().get(1, int32_t(replyDelayMax))));
+}
+
+void ArtPollResponder::beginRound() {
+    target = 0;
+    target_count = 0;
+    Request request{};
+    while (tx_queue_receive(&request_queue, &request, TX_NO_WAIT) == TX_SUCCESS) {
+        bool known = false;
+        for (size_t c = 0; c < target_count; c++) {
+            known |= memcmp(&targets[c], &request.from, sizeof(NXD_ADDRESS)) == 0;
+        }
+        if (!known && target_count < targets.size()) {
+            targets[target_count++] = request.from;
+        }
+    }
+
+    if (!template_valid) {
+        buildTemplate();
+    }
+
+    universe_count = Control::instance().activeArtnetUniverses(universes);
+    next_universe = 0;
+    bind_index = 1;
+}
+
+void ArtPollResponder::fire() {
+    if (target >= target_count) {
+        beginRound();
+    }
+
+    if (target < target_count && next_universe < universe_count) {
+        sendPage();
+    }
+    if (next_universe >= universe_count) {
+        target++;
+        next_universe = 0;
+        bind_index = 1;
+    }
+
+    if (target < target_count) {
+        TimerWheel::instance().add(timer, replyPacing);
+        return;
+    }
+
+    ULONG enqueued = 0;
+    tx_queue_info_get(&request_queue, NX_NULL, &enqueued, NX_NULL, NX_NULL, NX_NULL, NX_NULL);
+    if (enqueued) {
+        TimerWheel::instance().arm(timer, uint32_t(PseudoRandom::instance().get(1, int32_t(replyDelayMax))));
+    }
+}
+
+void ArtPollResponder::buildTemplate() {
+    Reply &reply = reply_template;
     memset(&reply, 0, sizeof(reply));
 
-    reply.opCode = OpPollReply;
+    reply.opCode = ArtNetPacket::OpPollReply;
     memcpy(reply.artNet, "Art-Net", 8);
-    reply.ipAddress[0] = (Network::instance().ipv4Addr()->nxd_ip_address.v4 >> 24) & 0xFF;
-    reply.ipAddress[1] = (Network::instance().ipv4Addr()->nxd_ip_address.v4 >> 16) & 0xFF;
-    reply.ipAddress[2] = (Network::instance().ipv4Addr()->nxd_ip_address.v4 >> 8) & 0xFF;
-    reply.ipAddress[3] = (Network::instance().ipv4Addr()->nxd_ip_address.v4 >> 0) & 0xFF;
-    reply.portNumber = 6454;
+    reply.portNumber = ArtNetPacket::port;
     reply.versionInfo = GIT_REV_COUNT_INT;
-    reply.netSwitch = uint8_t((universe >> 8) & 0xFF);
-    reply.subSwitch = uint8_t((universe >> 0) & 0xFF);
     reply.oem = 0x1ed5;
     reply.estaManufactor = 0x1ed5;
 
@@ -238,18 +390,51 @@ void ArtNetPacket::sendArtPollReply(const NXD_ADDRESS *from, uint16_t universe)
     }
 
     memcpy(reply.macAddress, Network::instance().MACAddr(), 6);
-    reply.bindIp[0] = (Network::instance().ipv4Addr()->nxd_ip_address.v4 >> 24) & 0xFF;
-    reply.bindIp[1] = (Network::instance().ipv4Addr()->nxd_ip_address.v4 >> 16) & 0xFF;
-    reply.bindIp[2] = (Network::instance().ipv4Addr()->nxd_ip_address.v4 >> 8) & 0xFF;
-    reply.bindIp[3] = (Network::instance().ipv4Addr()->nxd_ip_address.v4 >> 0) & 0xFF;
-
-    NXD_ADDRESS ipv4 = *Network::instance().ipv4Addr();
-    reply.status2 = 0x01 |                                         // support web browser config
-                    0x02 |                                         // supports dhcp
-                    (ipv4.nxd_ip_address.v4 == 0 ? 0x04 : 0x00) |  // using dhcp
-                    0x08;                                          // ArtNet3
-
-    Network::instance().ArtNetSend(from, port, (const uint8_t *)&reply, sizeof(reply));
+
+    template_valid = true;
+}
+
+void ArtPollResponder::sendPage() {
+    Reply reply = reply_template;
+
+    const uint32_t ipv4 = uint32_t(Network::instance().ipv4Addr()->nxd_ip_address.v4);
+    for (size_t c = 0; c < 4; c++) {
+        reply.ipAddress[c] = uint8_t(ipv4 >> (24 - c * 8));
+        reply.bindIp[c] = uint8_t(ipv4 >> (24 - c * 8));
+    }
+    reply.status2 = 0x01 |                      // support web browser config
+                    0x02 |                      // supports dhcp
+                    (ipv4 == 0 ? 0x04 : 0x00) |  // using dhcp
+                    0x08;                       // ArtNet3
+
+    // Ports in one reply share Net and Sub-Net; every reply is a page of the same node, told apart by BindIndex
+    const uint16_t group = universes[next_universe] & 0x7FF0;
+    size_t ports = 0;
+    for (; next_universe < universe_count && ports < portsPerReply && (universes[next_universe] & 0x7FF0) == group; next_universe++, ports++) {
+        reply.portTypes[ports] = 0x80;  // output from Art-Net, DMX512
+        reply.swOut[ports] = uint8_t(universes[next_universe] & 0x0F);
+    }
+    reply.netSwitch = uint8_t((group >> 8) & 0x7F);
+    reply.subSwitch = uint8_t((group >> 4) & 0x0F);
+    reply.numPortsLo = uint8_t(ports);
+    reply.bindIndex = bind_index++;
+
+    Network::instance().ArtNetSend(&targets[target], ArtNetPacket::port, (const uint8_t *)&reply, sizeof(reply));
+}
+
+void ArtNetPacket::updateUniverses() {
+    std::array<uint16_t, Model::maxUniverses> universes{};
+    sequenceTracker.setUniverses(std::span<const uint16_t>(universes.data(), Control::instance().activeArtnetUniverses(universes)));
+}
+
+void ArtNetPacket::sequenceStats(SequenceTracker::UniverseStats &out) { sequenceTracker.copyStats(out); }
+
+void ArtNetPacket::checkTimeouts() {
+    // Drop out of sync mode even when the controller went quiet altogether, not only when data keeps arriving
+    if (Control::instance().syncModeEnabled() && syncWatchDog.starved()) {
+        Control::instance().sync();
+        Control::instance().setEnableSyncMode(false);
+    }
 }
 
 bool ArtNetPacket::dispatch(const NXD_ADDRESS *from, const uint8_t *buf, size_t len, bool isBroadcast) {
@@ -259,7 +444,7 @@ bool ArtNetPacket::dispatch(const NXD_ADDRESS *from, const uint8_t *buf, size_t
     }
     switch (op) {
         case OpPoll: {
-            Control::instance().interateAllActiveArtnetUniverses([from](uint16_t universe) { Systick::instance().schedulePollReply(from, universe); });
+            ArtPollResponder::instance().schedule(from);
             return true;
         } break;
         case OpSync: {
@@ -277,7 +462,14 @@ bool ArtNetPacket::dispatch(const NXD_ADDRESS *from, const uint8_t *buf, size_t
             }
             OutputNzsPacket outputPacket;
             if (ArtNetPacket::verify(outputPacket, buf, len)) {
-                Control::instance().setArtnetUniverseOutputData(outputPacket.universe(), outputPacket.data(), outputPacket.len());
+                const uint32_t source = sourceAddress(from);
+                if (!acceptSequence(source, outputPacket.universe(), outputPacket.sequence())) {
+                    return false;
+                }
+                size_t datalen = outputPacket.len();
+                if (const uint8_t *data = artMerge.arbitrate(source, outputPacket.universe(), outputPacket.data(), datalen)) {
+                    Control::instance().setArtnetUniverseOutputData(outputPacket.universe(), data, datalen, outputPacket.sequence());
+                }
                 if (Control::instance().syncModeEnabled() && syncWatchDog.starved()) {
                     Control::instance().sync();
                     Control::instance().setEnableSyncMode(false);
@@ -291,7 +483,14 @@ bool ArtNetPacket::dispatch(const NXD_ADDRESS *from, const uint8_t *buf, size_t
             }
             OutputPacket outputPacket;
             if (ArtNetPacket::verify(outputPacket, buf, len)) {
-                Control::instance().setArtnetUniverseOutputData(outputPacket.universe(), outputPacket.data(), outputPacket.len());
+                const uint32_t source = sourceAddress(from);
+                if (!acceptSequence(source, outputPacket.universe(), outputPacket.sequence())) {
+                    return false;
+                }
+                size_t datalen = outputPacket.len();
+                if (const uint8_t *data = artMerge.arbitrate(source, outputPacket.universe(), outputPacket.data(), datalen)) {
+                    Control::instance().setArtnetUniverseOutputData(outputPacket.universe(), data, datalen, outputPacket.sequence());
+                }
                 if (Control::instance().syncModeEnabled() && syncWatchDog.starved()) {
                     Control::instance().sync();
                     Control::instance().setEnableSyncMode(false);
@@ -315,6 +514,9 @@ uint8_t OutputPacket::sequence() const { return packet[12]; }
 uint8_t OutputPacket::physical() const { return packet[13]; }
 
 bool OutputPacket::verify() const {
+    if (packet.size() < 18) {
+        return false;
+    }
     if (len() < 2) {
         return false;
     }
@@ -327,6 +529,9 @@ bool OutputPacket::verify() const {
     if (universe() >= 32768) {
         return false;
     }
+    if (packet.size() < 18 + len()) {
+        return false;
+    }
     return true;
 }
 
@@ -339,6 +544,9 @@ uint8_t OutputNzsPacket::sequence() const { return packet[12]; }
 uint8_t OutputNzsPacket::startCode() const { return packet[13]; }
 
 bool OutputNzsPacket::verify() const {
+    if (packet.size() < 18) {
+        return false;
+    }
     if (len() < 2) {
         return false;
     }
@@ -351,6 +559,9 @@ bool OutputNzsPacket::verify() const {
     if (universe() >= 32768) {
         return false;
     }
+    if (packet.size() < 18 + len()) {
+        return false;
+    }
     if (startCode() != 0) {
         return false;
     }
@@ -26,7 +26,11 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <stdint.h>
 
 #include <array>
+#include <span>
 
+#include "./model.h"
+#include "./sequence.h"
+#include "./timerwheel.h"
 #include "nx_api.h"
 
 class ArtSyncWatchDog {
@@ -35,8 +39,8 @@ class ArtSyncWatchDog {
     void feed();
 
    private:
-    constexpr static double ArtSyncTimeout = 4.0;
-    double fedtime = 0;
+    constexpr static uint32_t ArtSyncTimeoutMs = 4000;
+    uint64_t fedtime = 0;
 };
 
 class ArtNetPacket {
@@ -84,14 +88,20 @@ class ArtNetPacket {
     };
 
     static bool dispatch(const NXD_ADDRESS *from, const uint8_t *buf, size_t len, bool isBroadcast);
-    static void sendArtPollReply(const NXD_ADDRESS *from, uint16_t universe);
+    static void checkTimeouts();
+#ifndef BOOTLOADER
+    static void updateUniverses();
+    static void sequenceStats(SequenceTracker::UniverseStats &out);
+#endif  // #ifndef BOOTLOADER
 
    protected:
     ArtNetPacket(){};
     virtual ~ArtNetPacket() {}
 
+    static constexpr size_t maxPacketSize = 512 + 18;
+
     virtual bool verify() const { return false; }
-    std::array<uint8_t, 512 + 18> packet{};
+    std::span<const uint8_t> packet{};
     Opcode opcode() const;
     int version() const;
 
@@ -100,4 +110,88 @@ class ArtNetPacket {
     static bool verify(ArtNetPacket &Packet, const uint8_t *buf, size_t len);
 };
 
+#ifndef BOOTLOADER
+
+class ArtPollResponder {
+   public:
+    static ArtPollResponder &instance();
+
+    void schedule(const NXD_ADDRESS *from);
+    void invalidate() { template_valid = false; }
+
+   private:
+    static constexpr size_t portsPerReply = 4;
+    static constexpr size_t requestN = 4;
+    static constexpr ULONG replyDelayMax = TX_TIMER_TICKS_PER_SECOND;
+    static constexpr ULONG replyPacing = 2;
+
+    struct Reply {
+        uint8_t artNet[8];
+        uint16_t opCode;
+        uint8_t ipAddress[4];
+        uint16_t portNumber;
+        uint16_t versionInfo;
+        uint8_t netSwitch;
+        uint8_t subSwitch;
+        uint16_t oem;
+        uint8_t uebaVersion;
+        uint8_t status1;
+        uint16_t estaManufactor;
+        uint8_t shortName[18];
+        uint8_t longName[64];
+        uint8_t nodeReport[64];
+        uint8_t numPortsHi;
+        uint8_t numPortsLo;
+        uint8_t portTypes[4];
+        uint8_t goodInput[4];
+        uint8_t goodOutput[4];
+        uint8_t swIn[4];
+        uint8_t swOut[4];
+        uint8_t swVideo;
+        uint8_t swMacro;
+        uint8_t swRemote;
+        uint8_t spare1;
+        uint8_t spare2;
+        uint8_t spare3;
+        uint8_t style;
+        uint8_t macAddress[6];
+        uint8_t bindIp[4];
+        uint8_t bindIndex;
+        uint8_t status2;
+        uint8_t filler[26];
+    } __attribute__((packed));
+
+    struct Request {
+        NXD_ADDRESS from;
+        ULONG pad[8 - sizeof(NXD_ADDRESS) / sizeof(ULONG)];
+    };
+    static_assert(sizeof(Request) == 8 * sizeof(ULONG));
+
+    void fire();
+    void beginRound();
+    void buildTemplate();
+    void sendPage();
+
+    Reply reply_template{};
+    bool template_valid = false;
+
+    // One reply round: every queued poller gets all pages of a universe snapshot, one page per timer expiry
+    std::array<NXD_ADDRESS, requestN> targets{};
+    size_t target_count = 0;
+    size_t target = 0;
+    std::array<uint16_t, Model::maxUniverses> universes{};
+    size_t universe_count = 0;
+    size_t next_universe = 0;
+    uint8_t bind_index = 1;
+
+    bool initialized = false;
+    void init();
+
+    TimerWheel::Timer timer{[](void *) { ArtPollResponder::instance().fire(); }};
+    TX_QUEUE request_queue{};
+    ULONG request_storage[requestN * sizeof(Request) / sizeof(ULONG)]{};
+};
+
+#endif  // #ifndef BOOTLOADER
+
 #endif /* _ARTNET_H_ */
@@ -0,0 +1,80 @@
+/*
+Copyright 2023 Tinic Uro
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#ifndef BASELINE_STRIP_H_
+#define BASELINE_STRIP_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#include <array>
+
+#include "./model.h"
+
+// Strip conversions as they were before the streamed encoders and per-universe kernels, trimmed to what
+// the bench compares against. Frozen reference: keep it byte for byte with the old output. Apart from the
+// spi_buf slack below, the one deliberate change is in setUniverseData(): the old 16-bit SRGB paths for
+// WS2816 and HD108 indexed a uint16_t pointer by byte offset and spread components at twice the stride;
+// they use a byte pointer here.
+class BaselineStrip {
+   public:
+    static constexpr size_t dmxMaxLen = 512;
+    static constexpr size_t bytesMaxLen = (dmxMaxLen * Model::universeN);
+    static constexpr size_t bytesLatchLen = 64;
+    static constexpr size_t spiMaxLen = (bytesMaxLen * sizeof(uint32_t) + bytesLatchLen * sizeof(uint32_t));
+
+    BaselineStrip();
+
+    void setStripType(Model::StripConfig::StripOutputType type) { output_type = type; }
+    void setCompLimit(float value) { comp_limit = value; };
+    void setPixelLen(size_t len);
+    size_t getMaxPixelLen() const;
+    size_t getBytesPerPixel() const;
+    Model::StripConfig::StripNativeType nativeType() const;
+
+    void setUniverseData(const size_t N, const uint8_t *data, const size_t len, const Model::StripConfig::StripInputType input_type);
+    bool isUniverseActive(size_t uniN, Model::StripConfig::StripInputType input_type) const;
+
+    void ws2812_alike_convert(const size_t start, const size_t end);
+    void tls3001_alike_convert(size_t &len);
+
+    Model::StripConfig::StripOutputType output_type = Model::StripConfig::StripOutputType::WS2812;
+    bool strip_reset = false;
+    float comp_limit = 1.0f;
+
+    std::array<uint8_t, bytesMaxLen> comp_buf{};
+    // The old conversion writes one word past the end at full strip length; the slack keeps it off bytes_len
+    std::array<uint8_t, spiMaxLen + sizeof(uint32_t)> spi_buf{};
+    size_t bytes_len = 0;
+
+   private:
+    size_t getMaxBytesLen() const;
+    size_t getBytesPerInputPixel(Model::StripConfig::StripInputType input_type) const;
+    size_t getComponentsPerInputPixel(Model::StripConfig::StripInputType input_type) const;
+    size_t getComponentBytes(Model::StripConfig::StripInputType input_type) const;
+
+    static std::array<uint32_t, 256> ws2812_lut;
+    static bool hd108_lut_init;
+    static std::array<std::array<uint16_t, 256>, 3> hd108_lut;
+};
+
+#endif /* BASELINE_STRIP_H_ */
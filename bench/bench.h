@@ -0,0 +1,72 @@
+/*
+Copyright 2023 Tinic Uro
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#ifndef BENCH_H_
+#define BENCH_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+// Host benchmarks and differential checks. Every suite compares the current code against a reference
+// (the pre-optimization implementation where there is one) and times both. Timings are host numbers:
+// use them to compare the two paths, not to predict Cortex-M33 cycles.
+namespace Bench {
+
+// --check: run the differential checks only and skip the timing loops
+extern bool checkOnly;
+// Fed to Systick::systemTimeRAW()
+extern uint64_t cycles;
+extern std::mt19937 rng;
+
+void check(bool ok, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+void report(const char *name, double before, double after, const char *unit);
+void report(const char *name, double now, const char *unit);
+
+// Best of a few batches, in ns per call
+template <typename F>
+double nsPerCall(size_t calls, F &&f) {
+    double best = 1e30;
+    for (size_t batch = 0; batch < 5; batch++) {
+        const auto t0 = std::chrono::steady_clock::now();
+        for (size_t c = 0; c < calls; c++) {
+            f();
+            asm volatile("" ::: "memory");
+        }
+        const auto t1 = std::chrono::steady_clock::now();
+        best = std::min(best, double(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count()) / double(calls));
+    }
+    return best;
+}
+
+}  // namespace Bench
+
+void benchWS2812();
+void benchUniverseKernels();
+void benchTLS3001();
+void benchMerge();
+void checkSystick();
+
+#endif  // #ifndef BENCH_H_
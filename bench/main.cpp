@@ -0,0 +1,85 @@
+/*
+Copyright 2023 Tinic Uro
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include <stdarg.h>
+#include <string.h>
+
+#include "./bench.h"
+#include "./systick.h"
+
+uint32_t SystemCoreClock = 250000000;
+
+namespace Bench {
+
+bool checkOnly = false;
+uint64_t cycles = 0;
+std::mt19937 rng(12345);
+
+static size_t checks = 0;
+static size_t failures = 0;
+
+void check(bool ok, const char *fmt, ...) {
+    checks++;
+    if (ok) {
+        return;
+    }
+    if (failures++ < 20) {
+        va_list args;
+        va_start(args, fmt);
+        printf("FAIL: ");
+        vprintf(fmt, args);
+        printf("\n");
+        va_end(args);
+    }
+}
+
+void report(const char *name, double before, double after, const char *unit) {
+    printf("%-48s %10.2f -> %10.2f %-10s x%.2f\n", name, before, after, unit, before / after);
+}
+
+void report(const char *name, double now, const char *unit) { printf("%-48s %10s    %10.2f %s\n", name, "", now, unit); }
+
+}  // namespace Bench
+
+Systick &Systick::instance() {
+    static Systick systick;
+    return systick;
+}
+
+uint64_t Systick::systemTimeRAW() const { return Bench::cycles; }
+
+int main(int argc, char *argv[]) {
+    for (int c = 1; c < argc; c++) {
+        if (strcmp(argv[c], "--check") == 0) {
+            Bench::checkOnly = true;
+        }
+    }
+
+    checkSystick();
+    benchWS2812();
+    benchUniverseKernels();
+    benchTLS3001();
+    benchMerge();
+
+    printf("%zu checks, %zu failed\n", Bench::checks, Bench::failures);
+    return Bench::failures ? 1 : 0;
+}
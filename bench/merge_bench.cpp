@@ -0,0 +1,219 @@
+/*
+Copyright 2023 Tinic Uro
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include <string.h>
+
+#include <array>
+#include <vector>
+
+#include "./bench.h"
+#include "./merge.h"
+#include "./merge_dsp.h"
+
+// One universe as SourceMerge and ArtMerge see it
+static constexpr size_t slotN = 512;
+
+// Slot by slot, the way the merge would be written without the four-slot kernels
+struct ScalarMerge {
+    static void htp(uint8_t *dst, const uint8_t *a, const uint8_t *b, size_t len) {
+        for (size_t c = 0; c < len; c++) {
+            dst[c] = std::max(a[c], b[c]);
+        }
+    }
+
+    static void htp(uint8_t *dst, uint8_t *keep, const uint8_t *a, const uint8_t *b, size_t len) {
+        for (size_t c = 0; c < len; c++) {
+            const uint8_t v = a[c];
+            keep[c] = v;
+            dst[c] = std::max(v, b[c]);
+        }
+    }
+
+    static void prioritized(uint8_t *dst, uint8_t *dst_prio, const uint8_t *src, const uint8_t *src_prio, size_t len, bool htp) {
+        for (size_t c = 0; c < len; c++) {
+            if (src_prio[c] > dst_prio[c]) {
+                dst[c] = src[c];
+                dst_prio[c] = src_prio[c];
+            } else if (htp && src_prio[c] == dst_prio[c]) {
+                dst[c] = std::max(dst[c], src[c]);
+            }
+        }
+    }
+
+    static void release(uint8_t *dst, const uint8_t *src, const uint8_t *prio, size_t len) {
+        for (size_t c = 0; c < len; c++) {
+            dst[c] = prio[c] ? src[c] : 0;
+        }
+    }
+};
+
+struct MergeKernels {
+    const char *name;
+    void (*htp)(uint8_t *dst, const uint8_t *a, const uint8_t *b, size_t len);
+    void (*htpKeep)(uint8_t *dst, uint8_t *keep, const uint8_t *a, const uint8_t *b, size_t len);
+    void (*prioritized)(uint8_t *dst, uint8_t *dst_prio, const uint8_t *src, const uint8_t *src_prio, size_t len, bool htp);
+    void (*release)(uint8_t *dst, const uint8_t *src, const uint8_t *prio, size_t len);
+};
+
+template <typename M>
+static constexpr MergeKernels mergeKernels(const char *name) {
+    return {name, static_cast<void (*)(uint8_t *, const uint8_t *, const uint8_t *, size_t)>(&M::htp),
+            static_cast<void (*)(uint8_t *, uint8_t *, const uint8_t *, const uint8_t *, size_t)>(&M::htp), &M::prioritized, &M::release};
+}
+
+static const MergeKernels scalarKernels = mergeKernels<ScalarMerge>("scalar");
+static const std::array<MergeKernels, 2> mergePaths{mergeKernels<Merge>("SWAR"), mergeKernels<MergeDSP>("USUB8/SEL emu")};
+
+// Levels with plenty of ties, priorities from a few values (0 releases the slot) so every comparison outcome shows up
+static void fillLevels(uint8_t *p, size_t len) {
+    for (size_t c = 0; c < len; c++) {
+        p[c] = (Bench::rng() & 3) ? uint8_t(Bench::rng()) : uint8_t((Bench::rng() & 1) ? 0xFF : 0x80);
+    }
+}
+
+static void fillPriorities(uint8_t *p, size_t len) {
+    static constexpr std::array<uint8_t, 6> priorities{0, 1, 100, 100, 199, 200};
+    for (size_t c = 0; c < len; c++) {
+        p[c] = priorities[Bench::rng() % priorities.size()];
+    }
+}
+
+struct MergeFrame {
+    alignas(4) std::array<uint8_t, slotN + 4> a;
+    alignas(4) std::array<uint8_t, slotN + 4> b;
+    alignas(4) std::array<uint8_t, slotN + 4> pa;
+    alignas(4) std::array<uint8_t, slotN + 4> pb;
+};
+
+static void checkMerge(const MergeKernels &k) {
+    MergeFrame in{};
+    alignas(4) std::array<uint8_t, slotN + 4> ref{}, ref_keep{}, ref_prio{}, out{}, out_keep{}, out_prio{};
+
+    // Every pair of levels, 512 pairs per call
+    for (size_t c = 0; c < 65536 / slotN; c++) {
+        for (size_t d = 0; d < slotN; d++) {
+            in.a[d] = uint8_t(c * slotN + d);
+            in.b[d] = uint8_t((c * slotN + d) >> 8);
+        }
+        ScalarMerge::htp(ref.data(), in.a.data(), in.b.data(), slotN);
+        k.htp(out.data(), in.a.data(), in.b.data(), slotN);
+        Bench::check(out == ref, "%s htp differs on level pairs %zu", k.name, c);
+    }
+
+    for (size_t round = 0; round < 200; round++) {
+        // Odd lengths and offsets for the tail loop and unaligned words
+        const size_t len = round == 0 ? slotN : Bench::rng() % (slotN + 1);
+        const size_t off = round == 0 ? 0 : Bench::rng() % 4;
+        const bool htp = round & 1;
+        fillLevels(in.a.data(), in.a.size());
+        fillLevels(in.b.data(), in.b.size());
+        fillPriorities(in.pa.data(), in.pa.size());
+        fillPriorities(in.pb.data(), in.pb.size());
+
+        ref.fill(0x55);
+        out.fill(0x55);
+        ScalarMerge::htp(ref.data() + off, in.a.data() + off, in.b.data() + off, len);
+        k.htp(out.data() + off, in.a.data() + off, in.b.data() + off, len);
+        Bench::check(out == ref, "%s htp differs, len %zu offset %zu", k.name, len, off);
+
+        ref_keep.fill(0x55);
+        out_keep.fill(0x55);
+        ScalarMerge::htp(ref.data() + off, ref_keep.data() + off, in.a.data() + off, in.b.data() + off, len);
+        k.htpKeep(out.data() + off, out_keep.data() + off, in.a.data() + off, in.b.data() + off, len);
+        Bench::check(out == ref && out_keep == ref_keep, "%s htp with keep differs, len %zu offset %zu", k.name, len, off);
+
+        // In place, as the third and later sources are folded into the merged frame
+        ref = in.a;
+        out = in.a;
+        ScalarMerge::htp(ref.data() + off, ref.data() + off, in.b.data() + off, len);
+        k.htp(out.data() + off, out.data() + off, in.b.data() + off, len);
+        Bench::check(out == ref, "%s htp in place differs, len %zu offset %zu", k.name, len, off);
+
+        ref = in.a;
+        out = in.a;
+        ref_prio = in.pa;
+        out_prio = in.pa;
+        ScalarMerge::prioritized(ref.data() + off, ref_prio.data() + off, in.b.data() + off, in.pb.data() + off, len, htp);
+        k.prioritized(out.data() + off, out_prio.data() + off, in.b.data() + off, in.pb.data() + off, len, htp);
+        Bench::check(out == ref && out_prio == ref_prio, "%s prioritized differs, len %zu offset %zu htp %d", k.name, len, off, int(htp));
+
+        ScalarMerge::release(ref.data() + off, ref.data() + off, ref_prio.data() + off, len);
+        k.release(out.data() + off, out.data() + off, out_prio.data() + off, len);
+        Bench::check(out == ref, "%s release differs, len %zu offset %zu", k.name, len, off);
+    }
+}
+
+// The kernel calls SourceMerge::arbitrate() makes for one universe
+static void sourceMergeHTP(const MergeKernels &k, uint8_t *merged, uint8_t *keep, const MergeFrame &in, size_t sources) {
+    k.htpKeep(merged, keep, in.a.data(), in.b.data(), slotN);
+    for (size_t c = 2; c < sources; c++) {
+        k.htp(merged, merged, in.b.data(), slotN);
+    }
+}
+
+static void sourceMergePerAddress(const MergeKernels &k, uint8_t *merged, uint8_t *merged_prio, const MergeFrame &in, size_t sources) {
+    memcpy(merged, in.a.data(), slotN);
+    memcpy(merged_prio, in.pa.data(), slotN);
+    for (size_t c = 1; c < sources; c++) {
+        k.prioritized(merged, merged_prio, in.b.data(), in.pb.data(), slotN, true);
+    }
+    k.release(merged, merged, merged_prio, slotN);
+}
+
+static void timeMerge(const char *what, void (*run)(const MergeKernels &k, MergeFrame &in, uint8_t *x, uint8_t *y)) {
+    MergeFrame in{};
+    fillLevels(in.a.data(), in.a.size());
+    fillLevels(in.b.data(), in.b.size());
+    fillPriorities(in.pa.data(), in.pa.size());
+    fillPriorities(in.pb.data(), in.pb.size());
+    alignas(4) std::array<uint8_t, slotN + 4> x{}, y{};
+
+    const double before = Bench::nsPerCall(20000, [&] { run(scalarKernels, in, x.data(), y.data()); });
+    for (const MergeKernels &k : mergePaths) {
+        const double after = Bench::nsPerCall(20000, [&] { run(k, in, x.data(), y.data()); });
+        char name[64];
+        snprintf(name, sizeof(name), "merge %s, scalar -> %s", what, k.name);
+        Bench::report(name, before, after, "ns/univ");
+    }
+}
+
+void benchMerge() {
+    for (const MergeKernels &k : mergePaths) {
+        checkMerge(k);
+    }
+    if (Bench::checkOnly) {
+        return;
+    }
+
+    timeMerge("htp", [](const MergeKernels &k, MergeFrame &in, uint8_t *x, uint8_t *) { k.htp(x, in.a.data(), in.b.data(), slotN); });
+    timeMerge("htp with keep", [](const MergeKernels &k, MergeFrame &in, uint8_t *x, uint8_t *y) { k.htpKeep(x, y, in.a.data(), in.b.data(), slotN); });
+    timeMerge("prioritized htp", [](const MergeKernels &k, MergeFrame &in, uint8_t *x, uint8_t *y) {
+        memcpy(x, in.a.data(), slotN);
+        memcpy(y, in.pa.data(), slotN);
+        k.prioritized(x, y, in.b.data(), in.pb.data(), slotN, true);
+    });
+    timeMerge("release", [](const MergeKernels &k, MergeFrame &in, uint8_t *x, uint8_t *) { k.release(x, in.a.data(), in.pa.data(), slotN); });
+    timeMerge("2 src htp", [](const MergeKernels &k, MergeFrame &in, uint8_t *x, uint8_t *y) { sourceMergeHTP(k, x, y, in, 2); });
+    timeMerge("4 src htp", [](const MergeKernels &k, MergeFrame &in, uint8_t *x, uint8_t *y) { sourceMergeHTP(k, x, y, in, 4); });
+    timeMerge("2 src per-address", [](const MergeKernels &k, MergeFrame &in, uint8_t *x, uint8_t *y) { sourceMergePerAddress(k, x, y, in, 2); });
+    timeMerge("4 src per-address", [](const MergeKernels &k, MergeFrame &in, uint8_t *x, uint8_t *y) { sourceMergePerAddress(k, x, y, in, 4); });
+}
@@ -0,0 +1,265 @@
+/*
+Copyright 2023 Tinic Uro
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include <string.h>
+
+#include <magic_enum.hpp>
+#include <vector>
+
+#include "./baseline_strip.h"
+#include "./bench.h"
+#include "./strip.h"
+
+using SC = Model::StripConfig;
+
+class StripBench {
+   public:
+    explicit StripBench(SC::StripOutputType type) {
+        strip.init();
+        baseline.setStripType(type);
+        strip.setStripType(type);
+    }
+
+    void setPixelLen(size_t pixels) {
+        strip.setPixelLen(pixels);
+        baseline.setPixelLen(pixels);
+    }
+
+    void setCompLimit(float limit) {
+        strip.setCompLimit(limit);
+        baseline.setCompLimit(limit);
+    }
+
+    void clear() {
+        memset(strip.comp_buf, 0, Strip::bytesMaxLen);
+        baseline.comp_buf.fill(0);
+        strip.universe_hash_valid = 0;
+    }
+
+    bool sameComponents() const { return memcmp(strip.comp_buf, baseline.comp_buf.data(), Strip::bytesMaxLen) == 0; }
+
+    // setUniverseData() without the unchanged-payload shortcut, so repeated calls do the conversion
+    void convertUniverse(size_t uniN, const uint8_t *data, size_t len, SC::StripInputType input_type) {
+        strip.universe_hash_valid = 0;
+        strip.setUniverseData(uniN, data, len, input_type);
+    }
+
+    size_t bytesLen() const { return strip.bytes_len; }
+    size_t maxPixelLen() const { return strip.getMaxPixelLen(); }
+
+    // Same component bytes in both, as if a frame had been published
+    void loadFrame(const std::vector<uint8_t> &data) {
+        memcpy(strip.comp_buf, data.data(), data.size());
+        memcpy(baseline.comp_buf.data(), data.data(), data.size());
+        strip.frame_buf = strip.comp_buf;
+    }
+
+    // Whole frame through streamFill() in DMA sized chunks
+    size_t stream(std::vector<uint8_t> &out) {
+        strip.stream_pos = 0;
+        strip.stream_len = strip.streamLen();
+        out.clear();
+        while (strip.streamFill(chunk.data(), chunk.size()) > 0) {
+            out.insert(out.end(), chunk.begin(), chunk.end());
+        }
+        return out.size();
+    }
+
+    void streamFrame() {
+        strip.stream_pos = 0;
+        strip.stream_len = strip.streamLen();
+        while (strip.streamFill(chunk.data(), chunk.size()) > 0) {
+        }
+    }
+
+    // TLS3001 frame program in chunks of the given sizes until it runs out
+    template <typename F>
+    size_t streamTLS3001(bool reset, std::vector<uint8_t> &out, F &&chunkLen) {
+        strip.tls3001_state = {};
+        strip.tls3001_state.reset_frame = reset;
+        out.clear();
+        std::vector<uint8_t> buf(Strip::streamBufLen);
+        for (;;) {
+            const size_t want = std::min(buf.size(), size_t(chunkLen()));
+            const size_t got = strip.tls3001_alike_convert(buf.data(), want);
+            out.insert(out.end(), buf.begin(), buf.begin() + ptrdiff_t(got));
+            if (got < want) {
+                return out.size();
+            }
+        }
+    }
+
+    void streamTLS3001Frame(bool reset) {
+        strip.tls3001_state = {};
+        strip.tls3001_state.reset_frame = reset;
+        while (strip.streamFill(chunk.data(), chunk.size()) > 0) {
+        }
+    }
+
+    // Whole frame in one call, no chunking
+    void convertFrame() {
+        whole.resize(strip.streamLen());
+        strip.ws2812_alike_convert(whole.data(), 0, whole.size());
+    }
+
+    Strip strip;
+    BaselineStrip baseline;
+
+   private:
+    std::array<uint8_t, Strip::streamChunkLen> chunk{};
+    std::vector<uint8_t> whole{};
+};
+
+static std::vector<uint8_t> randomBytes(size_t len) {
+    std::vector<uint8_t> data(len);
+    for (auto &b : data) {
+        b = uint8_t(Bench::rng());
+    }
+    return data;
+}
+
+void benchWS2812() {
+    auto *b = new StripBench(SC::WS2812);
+
+    // Bit cells against the LUT conversion, full and random lengths, streamed in chunks
+    std::vector<uint8_t> out;
+    for (size_t it = 0; it < 200; it++) {
+        const size_t pixels = it == 0 ? b->maxPixelLen() : 1 + Bench::rng() % b->maxPixelLen();
+        b->setPixelLen(pixels);
+        b->strip.setNrzBits(4);
+        b->loadFrame(randomBytes(b->bytesLen()));
+        b->baseline.ws2812_alike_convert(0, b->baseline.bytes_len + BaselineStrip::bytesLatchLen);
+        b->stream(out);
+        const size_t len = (b->baseline.bytes_len + BaselineStrip::bytesLatchLen) * 4;
+        Bench::check(out.size() >= len && memcmp(out.data(), b->baseline.spi_buf.data(), len) == 0, "ws2812 stream differs from LUT path, %zu pixels", pixels);
+    }
+
+    if (!Bench::checkOnly) {
+        const size_t pixels = b->maxPixelLen();
+        b->setPixelLen(pixels);
+        b->loadFrame(randomBytes(b->bytesLen()));
+        const double lut = Bench::nsPerCall(200, [&] { b->baseline.ws2812_alike_convert(0, b->baseline.bytes_len + BaselineStrip::bytesLatchLen); });
+        b->strip.setNrzBits(4);
+        const double swar = Bench::nsPerCall(200, [&] { b->convertFrame(); });
+        const double stream = Bench::nsPerCall(200, [&] { b->streamFrame(); });
+        b->strip.setNrzBits(3);
+        const double nrz3 = Bench::nsPerCall(200, [&] { b->streamFrame(); });
+        Bench::report("ws2812 full strip, LUT -> SWAR", lut / double(pixels), swar / double(pixels), "ns/pixel");
+        Bench::report("ws2812 full strip, SWAR in 512 byte chunks", stream / double(pixels), "ns/pixel");
+        Bench::report("ws2812 full strip, 3-bit cells in chunks", nrz3 / double(pixels), "ns/pixel");
+    }
+
+    delete b;
+}
+
+void benchUniverseKernels() {
+    auto *b = new StripBench(SC::WS2812);
+    const size_t outN = magic_enum::enum_count<SC::StripOutputType>();
+    const size_t inN = magic_enum::enum_count<SC::StripInputType>();
+    const std::vector<uint8_t> full = randomBytes(Strip::dmxMaxLen);
+
+    for (size_t o = 0; o < outN; o++) {
+        for (size_t i = 0; i < inN; i++) {
+            for (float limit : {1.0f, 0.73f}) {
+                const auto out = SC::StripOutputType(o);
+                const auto in = SC::StripInputType(i);
+                b->strip.setStripType(out);
+                b->baseline.setStripType(out);
+                b->setCompLimit(limit);
+                b->setPixelLen(b->maxPixelLen());
+                b->clear();
+
+                // Random payloads and lengths into every universe, compared after each round
+                for (size_t round = 0; round < 3; round++) {
+                    for (size_t u = 0; u < Model::universeN; u++) {
+                        const std::vector<uint8_t> data = randomBytes(1 + Bench::rng() % Strip::dmxMaxLen);
+                        b->strip.setUniverseData(u, data.data(), data.size(), in);
+                        b->baseline.setUniverseData(u, data.data(), data.size(), in);
+                    }
+                    Bench::check(b->sameComponents(), "universe kernel differs: %.*s <- %.*s, limit %.2f, round %zu", int(magic_enum::enum_name(out).size()),
+                                 magic_enum::enum_name(out).data(), int(magic_enum::enum_name(in).size()), magic_enum::enum_name(in).data(), double(limit), round);
+                }
+
+                if (Bench::checkOnly) {
+                    continue;
+                }
+
+                // Full 512 byte universe, all universes of a full strip
+                const double before = Bench::nsPerCall(50, [&] {
+                    for (size_t u = 0; u < Model::universeN; u++) {
+                        b->baseline.setUniverseData(u, full.data(), full.size(), in);
+                    }
+                });
+                const double after = Bench::nsPerCall(50, [&] {
+                    for (size_t u = 0; u < Model::universeN; u++) {
+                        b->convertUniverse(u, full.data(), full.size(), in);
+                    }
+                });
+                char name[64];
+                snprintf(name, sizeof(name), "universe %.*s <- %.*s, limit %.2f", int(magic_enum::enum_name(out).size()), magic_enum::enum_name(out).data(),
+                         int(magic_enum::enum_name(in).size()), magic_enum::enum_name(in).data(), double(limit));
+                Bench::report(name, before / Model::universeN, after / Model::universeN, "ns/univ");
+            }
+        }
+    }
+
+    delete b;
+}
+
+void benchTLS3001() {
+    auto *b = new StripBench(SC::TLS3001);
+
+    // Manchester stream against the per-bit encoder, reset and data frames, full and random lengths, odd chunk sizes
+    std::vector<uint8_t> out;
+    for (size_t it = 0; it < 200; it++) {
+        for (bool reset : {true, false}) {
+            const size_t pixels = it == 0 ? b->maxPixelLen() : 1 + Bench::rng() % b->maxPixelLen();
+            b->setPixelLen(pixels);
+            b->loadFrame(randomBytes(b->bytesLen()));
+            b->baseline.strip_reset = !reset;
+            size_t len = 0;
+            b->baseline.tls3001_alike_convert(len);
+            b->streamTLS3001(reset, out, [] { return 1 + Bench::rng() % 700; });
+            // The old encoder always flushed one more byte; past the last bit it is zero either way
+            const auto &ref = b->baseline.spi_buf;
+            Bench::check(out.size() <= len && memcmp(out.data(), ref.data(), out.size()) == 0 &&
+                             std::all_of(ref.begin() + ptrdiff_t(out.size()), ref.begin() + ptrdiff_t(len), [](uint8_t v) { return v == 0; }),
+                         "tls3001 stream differs from per-bit encoder, %zu pixels, %s frame", pixels, reset ? "reset" : "data");
+        }
+    }
+
+    if (!Bench::checkOnly) {
+        b->setPixelLen(b->maxPixelLen());
+        b->loadFrame(randomBytes(b->bytesLen()));
+        for (bool reset : {false, true}) {
+            const double before = Bench::nsPerCall(50, [&] {
+                size_t len = 0;
+                b->baseline.strip_reset = !reset;
+                b->baseline.tls3001_alike_convert(len);
+            });
+            const double after = Bench::nsPerCall(50, [&] { b->streamTLS3001Frame(reset); });
+            Bench::report(reset ? "tls3001 16 universes, reset frame" : "tls3001 16 universes, data frame", before / 1000.0, after / 1000.0, "us/frame");
+        }
+    }
+
+    delete b;
+}
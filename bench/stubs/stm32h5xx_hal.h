@@ -0,0 +1,60 @@
+/*
+Copyright 2023 Tinic Uro
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+// Host stand-in for the parts of the STM32 HAL and CMSIS that the benched sources touch
+#ifndef STM32H5XX_HAL_H
+#define STM32H5XX_HAL_H
+
+#include <stdint.h>
+
+extern uint32_t SystemCoreClock;
+
+static inline uint32_t __get_PRIMASK() { return 0; }
+static inline void __set_PRIMASK(uint32_t) {}
+static inline void __disable_irq() {}
+static inline void __enable_irq() {}
+
+// USUB8 sets one GE flag per byte lane where a >= b and SEL picks each lane from a or b on those flags.
+// Emulated so the DSP build of merge.cpp can be checked on the host; the timings of that build mean little.
+inline uint32_t bench_ge_flags = 0;
+
+static inline uint32_t __USUB8(uint32_t a, uint32_t b) {
+    uint32_t r = 0;
+    bench_ge_flags = 0;
+    for (uint32_t lane = 0; lane < 4; lane++) {
+        const uint32_t la = (a >> (lane * 8)) & 0xFF;
+        const uint32_t lb = (b >> (lane * 8)) & 0xFF;
+        bench_ge_flags |= (la >= lb ? 1U : 0U) << lane;
+        r |= ((la - lb) & 0xFF) << (lane * 8);
+    }
+    return r;
+}
+
+static inline uint32_t __SEL(uint32_t a, uint32_t b) {
+    uint32_t r = 0;
+    for (uint32_t lane = 0; lane < 4; lane++) {
+        r |= (((bench_ge_flags >> lane) & 1) ? a : b) & (0xFFU << (lane * 8));
+    }
+    return r;
+}
+
+#endif  // #ifndef STM32H5XX_HAL_H
@@ -0,0 +1,68 @@
+/*
+Copyright 2023 Tinic Uro
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "./bench.h"
+#include "./systick.h"
+
+// Time helpers against Bench::cycles at the bench's 250 MHz SystemCoreClock. No timings, checks only.
+void checkSystick() {
+    const uint64_t top = UINT64_MAX;
+
+    Bench::check(Systick::elapsed(5, top - 10, 10), "elapsed across the 2^64 wrap");
+    Bench::check(!Systick::elapsed(5, top - 3, 10), "not yet elapsed across the 2^64 wrap");
+    Bench::check(!Systick::elapsed(100, 100, 0), "zero period on the same tick");
+    Bench::check(Systick::elapsed(101, 100, 0), "zero period one tick later");
+    Bench::check(Systick::reached(2, top - 1), "reached across the 2^64 wrap");
+    Bench::check(!Systick::reached(top - 1, 2), "not reached before the 2^64 wrap");
+    Bench::check(Systick::reached(7, 7), "reached at the deadline");
+
+    Bench::check(Systick::cyclesPerMS() == 250000, "cyclesPerMS at 250 MHz");
+    Bench::check(Systick::msToCycles(1000) == 250000000, "msToCycles(1000)");
+    Bench::check(Systick::msToCycles(0xFFFFFFFF) == uint64_t(0xFFFFFFFF) * 250000, "msToCycles(0xFFFFFFFF) without 32-bit overflow");
+
+    // Deadlines at boot, past 2^32 cycles and just before the 2^64 wrap
+    for (const uint64_t base : {uint64_t(0), uint64_t(1) << 32, top - Systick::msToCycles(500)}) {
+        const uint64_t deadline = base + Systick::msToCycles(250);
+        Bench::check(!Systick::reached(base, deadline), "deadline %#llx reached early", (unsigned long long)deadline);
+        Bench::check(!Systick::reached(deadline - 1, deadline), "deadline %#llx reached a cycle early", (unsigned long long)deadline);
+        Bench::check(Systick::reached(deadline, deadline), "deadline %#llx missed", (unsigned long long)deadline);
+        Bench::check(Systick::reached(deadline + Systick::msToCycles(1000), deadline), "deadline %#llx forgotten", (unsigned long long)deadline);
+        Bench::check(!Systick::elapsed(deadline, base, Systick::msToCycles(250)), "period from %#llx elapsed early", (unsigned long long)base);
+        Bench::check(Systick::elapsed(deadline + 1, base, Systick::msToCycles(250)), "period from %#llx missed", (unsigned long long)base);
+    }
+
+    const Systick &systick = Systick::instance();
+    uint32_t last = 0;
+    for (uint32_t ms = 0; ms < 3000; ms++) {
+        Bench::cycles = Systick::msToCycles(ms);
+        const uint32_t phase = systick.phase(1000);
+        Bench::check(phase < 65536 && phase == ((ms % 1000) << 16) / 1000, "phase(1000) at %u ms is %u", ms, phase);
+        if (ms % 1000) {
+            Bench::check(phase > last, "phase(1000) not increasing at %u ms", ms);
+        }
+        last = phase;
+    }
+
+    Bench::cycles = (uint64_t(1) << 40) + 12345;
+    Bench::check(systick.systemTimeMS() == uint32_t(Bench::cycles / 250000), "systemTimeMS past 2^32 cycles");
+    Bench::cycles = 0;
+}
@@ -97,9 +97,9 @@ class ColorSpaceConverter {
         int32_t y = mul_fixed(srgbl2ledl_fixed[3], lr) + mul_fixed(srgbl2ledl_fixed[4], lg) + mul_fixed(srgbl2ledl_fixed[5], lb);
         int32_t z = mul_fixed(srgbl2ledl_fixed[6], lr) + mul_fixed(srgbl2ledl_fixed[7], lg) + mul_fixed(srgbl2ledl_fixed[8], lb);
 
-        pwm_r = uint16_t((std::clamp((x >> fixed_post_shift), int32_t(0), fixed_post_clamp) * pwm_l) / fixed_post_clamp);
-        pwm_g = uint16_t((std::clamp((y >> fixed_post_shift), int32_t(0), fixed_post_clamp) * pwm_l) / fixed_post_clamp);
-        pwm_b = uint16_t((std::clamp((z >> fixed_post_shift), int32_t(0), fixed_post_clamp) * pwm_l) / fixed_post_clamp);
+        pwm_r = uint16_t((uint32_t(std::clamp((x >> fixed_post_shift), int32_t(0), fixed_post_clamp)) * pwm_l) / uint32_t(fixed_post_clamp));
+        pwm_g = uint16_t((uint32_t(std::clamp((y >> fixed_post_shift), int32_t(0), fixed_post_clamp)) * pwm_l) / uint32_t(fixed_post_clamp));
+        pwm_b = uint16_t((uint32_t(std::clamp((z >> fixed_post_shift), int32_t(0), fixed_post_clamp)) * pwm_l) / uint32_t(fixed_post_clamp));
 #else
         float col[3];
         col[0] = float(srgb_r) * (1.0f / 255.0f);
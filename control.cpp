@@ -26,8 +26,11 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <stdint.h>
 #include <string.h>
 
+#include <algorithm>
+
 #include "./color.h"
 #include "./driver.h"
+#include "./network.h"
 #include "./spi.h"
 #include "./strip.h"
 #include "./systick.h"
@@ -114,578 +117,383 @@ void Control::sync() {
     }
 }
 
-void Control::collectAllActiveArtnetUniverses(std::array<uint16_t, Model::maxUniverses> &universes, size_t &universeCount) {
-    universeCount = 0;
-    class UniqueCollector {
-       public:
-        UniqueCollector() { memset(&collected_universes[0], 0xFF, sizeof(collected_universes)); }
+void Control::RoutingTable::clear() {
+    route_count = 0;
+    buckets = {};
+}
 
-        void maybeAcquire(uint16_t universe) {
-            for (size_t c = 0; c < Model::maxUniverses; c++) {
-                if (collected_universes[c] == universe) {
-                    return;
-                }
-                if (collected_universes[c] == 0xFFFF) {
-                    collected_universes[c] = universe;
-                    return;
-                }
+void Control::RoutingTable::add(uint16_t universe, const Route &route) {
+    if (route_count >= routes.size()) {
+        return;
+    }
+    universes[route_count] = universe;
+    routes[route_count] = route;
+    route_count++;
+}
+
+void Control::RoutingTable::compile() {
+    const uint32_t generation = active_generation.load(std::memory_order_relaxed) + 1;
+    ActiveSet &active = active_sets[generation & 1];
+    active.count = 0;
+    // Group routes by universe so each bucket can point at one contiguous run
+    for (size_t c = 1; c < route_count; c++) {
+        for (size_t d = c; d > 0 && universes[d - 1] > universes[d]; d--) {
+            std::swap(universes[d - 1], universes[d]);
+            std::swap(routes[d - 1], routes[d]);
+        }
+    }
+    for (size_t c = 0; c < route_count;) {
+        size_t n = 1;
+        while (c + n < route_count && universes[c + n] == universes[c]) {
+            n++;
+        }
+        for (size_t h = universes[c];; h++) {
+            Bucket &bucket = buckets[h & (bucketN - 1)];
+            if (bucket.count == 0) {
+                bucket = {universes[c], uint8_t(c), uint8_t(n)};
+                break;
             }
         }
+        active.universes[active.count++] = universes[c];
+        c += n;
+    }
+    active_generation.store(generation, std::memory_order_release);
+}
 
-        void fillArray(std::array<uint16_t, Model::maxUniverses> &universes, size_t &universeCount) {
-            for (size_t c = 0; c < Model::maxUniverses; c++) {
-                if (collected_universes[c] == 0xFFFF) {
-                    return;
-                }
-                universes[universeCount++] = collected_universes[c];
-            }
+size_t Control::RoutingTable::copyActive(std::span<uint16_t> out) const {
+    for (;;) {
+        const uint32_t generation = active_generation.load(std::memory_order_acquire);
+        const ActiveSet &active = active_sets[generation & 1];
+        const size_t count = std::min(active.count, out.size());
+        std::copy_n(active.universes.begin(), count, out.begin());
+        std::atomic_thread_fence(std::memory_order_acquire);
+        // The set copied from is only rewritten after the next publish, so an unchanged generation means the copy is whole
+        if (active_generation.load(std::memory_order_relaxed) == generation) {
+            return count;
+        }
+    }
+}
+
+std::span<const Control::Route> Control::RoutingTable::find(uint16_t universe) const {
+    for (size_t h = universe;; h++) {
+        const Bucket &bucket = buckets[h & (bucketN - 1)];
+        if (bucket.count == 0) {
+            return {};
+        }
+        if (bucket.universe == universe) {
+            return std::span<const Route>(&routes[bucket.first], bucket.count);
         }
+    }
+}
 
-       private:
-        uint16_t collected_universes[Model::maxUniverses];
-    } uniqueCollector;
+void Control::buildRoutes() {
+    artnet_routes.clear();
+    e131_routes.clear();
 
+    size_t strip_first = Model::stripN;
+    size_t terminals = 0;
+    size_t components = 0;
     switch (Model::instance().outputConfig()) {
         case Model::DUAL_STRIP: {
-            for (size_t c = 0; c < Model::stripN; c++) {
-                for (size_t d = 0; d < Model::universeN; d++) {
-                    if (Strip::get(c).isUniverseActive(d, Model::instance().stripConfig(c).input_type)) {
-                        uniqueCollector.maybeAcquire(Model::instance().artnetStrip(c, d));
-                    }
-                }
-            }
+            strip_first = 0;
         } break;
         case Model::RGB_DUAL_STRIP: {
-            for (size_t c = 0; c < 3; c++) {
-                uniqueCollector.maybeAcquire(Model::instance().analogConfig(0).components[c].artnet.universe);
-            }
-            for (size_t c = 0; c < Model::stripN; c++) {
-                for (size_t d = 0; d < Model::universeN; d++) {
-                    if (Strip::get(c).isUniverseActive(d, Model::instance().stripConfig(c).input_type)) {
-                        uniqueCollector.maybeAcquire(Model::instance().artnetStrip(c, d));
-                    }
-                }
-            }
+            strip_first = 0;
+            terminals = 1;
+            components = 3;
         } break;
         case Model::RGB_STRIP: {
-            for (size_t c = 0; c < 3; c++) {
-                uniqueCollector.maybeAcquire(Model::instance().analogConfig(0).components[c].artnet.universe);
-            }
-            for (size_t c = 1; c < Model::stripN; c++) {
-                for (size_t d = 0; d < Model::universeN; d++) {
-                    if (Strip::get(c).isUniverseActive(d, Model::instance().stripConfig(c).input_type)) {
-                        uniqueCollector.maybeAcquire(Model::instance().artnetStrip(c, d));
-                    }
-                }
-            }
+            strip_first = 1;
+            terminals = 1;
+            components = 3;
         } break;
         case Model::RGBW_STRIP: {
-            for (size_t c = 0; c < 4; c++) {
-                uniqueCollector.maybeAcquire(Model::instance().analogConfig(0).components[c].artnet.universe);
-            }
-            for (size_t c = 1; c < Model::stripN; c++) {
-                for (size_t d = 0; d < Model::universeN; d++) {
-                    if (Strip::get(c).isUniverseActive(d, Model::instance().stripConfig(c).input_type)) {
-                        uniqueCollector.maybeAcquire(Model::instance().artnetStrip(c, d));
-                    }
-                }
-            }
+            strip_first = 1;
+            terminals = 1;
+            components = 4;
         } break;
         case Model::RGB_RGB: {
-            for (size_t c = 0; c < Model::analogN; c++) {
-                for (size_t d = 0; d < 3; d++) {
-                    uniqueCollector.maybeAcquire(Model::instance().analogConfig(c).components[d].artnet.universe);
-                }
-            }
+            terminals = Model::analogN;
+            components = 3;
         } break;
         case Model::RGBWWW: {
-            for (size_t c = 0; c < 1; c++) {
-                for (size_t d = 0; d < 5; d++) {
-                    uniqueCollector.maybeAcquire(Model::instance().analogConfig(c).components[d].artnet.universe);
-                }
-            }
+            terminals = Model::analogN;
+            components = 5;
         } break;
         default: {
         } break;
     }
 
-    uniqueCollector.fillArray(universes, universeCount);
-}
-
-void Control::collectAllActiveE131Universes(std::array<uint16_t, Model::maxUniverses> &universes, size_t &universeCount) {
-    universeCount = 0;
-    class UniqueCollector {
-       public:
-        UniqueCollector() { memset(&collected_universes[0], 0xFF, sizeof(collected_universes)); }
-
-        void maybeAcquire(uint16_t universe) {
-            for (size_t c = 0; c < Model::maxUniverses; c++) {
-                if (collected_universes[c] == universe) {
-                    return;
-                }
-                if (collected_universes[c] == 0xFFFF) {
-                    collected_universes[c] = universe;
-                    return;
-                }
+    for (size_t c = strip_first; c < Model::stripN; c++) {
+        const auto input_type = Model::instance().stripConfig(c).input_type;
+        for (size_t d = 0; d < Model::universeN; d++) {
+            if (Strip::get(c).isUniverseActive(d, input_type)) {
+                const Route route{Route::STRIP, uint8_t(c), uint8_t(d), input_type, 0};
+                artnet_routes.add(Model::instance().artnetStrip(c, d), route);
+                e131_routes.add(Model::instance().e131Strip(c, d), route);
             }
         }
+    }
 
-        void fillArray(std::array<uint16_t, Model::maxUniverses> &universes, size_t &universeCount) {
-            for (size_t c = 0; c < Model::maxUniverses; c++) {
-                if (collected_universes[c] == 0xFFFF) {
-                    return;
-                }
-                universes[universeCount++] = collected_universes[c];
-            }
+    for (size_t c = 0; c < terminals; c++) {
+        for (size_t d = 0; d < components; d++) {
+            const auto &component = Model::instance().analogConfig(c).components[d];
+            artnet_routes.add(component.artnet.universe, {Route::ANALOG, uint8_t(c), uint8_t(d), Model::StripConfig::RGB8,
+                                                          uint16_t(std::clamp(component.artnet.channel - 1, 0, 511))});
+            e131_routes.add(component.e131.universe,
+                            {Route::ANALOG, uint8_t(c), uint8_t(d), Model::StripConfig::RGB8, uint16_t(std::clamp(component.e131.channel - 1, 0, 511))});
         }
+    }
 
-       private:
-        uint16_t collected_universes[Model::maxUniverses];
-    } uniqueCollector;
-
-    switch (Model::instance().outputConfig()) {
-        case Model::DUAL_STRIP: {
-            for (size_t c = 0; c < Model::stripN; c++) {
-                for (size_t d = 0; d < Model::universeN; d++) {
-                    if (Strip::get(c).isUniverseActive(d, Model::instance().stripConfig(c).input_type)) {
-                        uniqueCollector.maybeAcquire(Model::instance().e131Strip(c, d));
-                    }
-                }
-            }
-        } break;
-        case Model::RGB_DUAL_STRIP: {
-            for (size_t c = 0; c < 3; c++) {
-                uniqueCollector.maybeAcquire(Model::instance().analogConfig(0).components[c].e131.universe);
-            }
-            for (size_t c = 0; c < Model::stripN; c++) {
-                for (size_t d = 0; d < Model::universeN; d++) {
-                    if (Strip::get(c).isUniverseActive(d, Model::instance().stripConfig(c).input_type)) {
-                        uniqueCollector.maybeAcquire(Model::instance().e131Strip(c, d));
-                    }
-                }
-            }
-        } break;
-        case Model::RGB_STRIP: {
-            for (size_t c = 0; c < 3; c++) {
-                uniqueCollector.maybeAcquire(Model::instance().analogConfig(0).components[c].e131.universe);
-            }
-            for (size_t c = 1; c < Model::stripN; c++) {
-                for (size_t d = 0; d < Model::universeN; d++) {
-                    if (Strip::get(c).isUniverseActive(d, Model::instance().stripConfig(c).input_type)) {
-                        uniqueCollector.maybeAcquire(Model::instance().e131Strip(c, d));
-                    }
-                }
-            }
-        } break;
-        case Model::RGBW_STRIP: {
-            for (size_t c = 0; c < 4; c++) {
-                uniqueCollector.maybeAcquire(Model::instance().analogConfig(0).components[c].e131.universe);
-            }
-            for (size_t c = 1; c < Model::stripN; c++) {
-                for (size_t d = 0; d < Model::universeN; d++) {
-                    if (Strip::get(c).isUniverseActive(d, Model::instance().stripConfig(c).input_type)) {
-                        uniqueCollector.maybeAcquire(Model::instance().e131Strip(c, d));
-                    }
-                }
-            }
-        } break;
-        case Model::RGB_RGB: {
-            for (size_t c = 0; c < Model::analogN; c++) {
-                for (size_t d = 0; d < 3; d++) {
-                    uniqueCollector.maybeAcquire(Model::instance().analogConfig(c).components[d].e131.universe);
-                }
-            }
-        } break;
-        case Model::RGBWWW: {
-            for (size_t c = 0; c < 1; c++) {
-                for (size_t d = 0; d < 5; d++) {
-                    uniqueCollector.maybeAcquire(Model::instance().analogConfig(c).components[d].e131.universe);
-                }
-            }
-        } break;
-        default: {
-        } break;
+    ddp_strip_count = 0;
+    for (size_t c = 0; c < Model::stripN; c++) {
+        const size_t strip = Model::instance().ddpStripOrder[c];
+        if (strip >= strip_first && strip < Model::stripN) {
+            ddp_strips[ddp_strip_count++] = uint8_t(strip);
+        }
     }
-    uniqueCollector.fillArray(universes, universeCount);
-}
 
-void Control::interateAllActiveArtnetUniverses(std::function<void(uint16_t universe)> callback) {
-    size_t universeCount = 0;
-    std::array<uint16_t, Model::maxUniverses> universes;
-    collectAllActiveArtnetUniverses(universes, universeCount);
+    artnet_routes.compile();
+    e131_routes.compile();
 
-    for (size_t c = 0; c < universeCount; c++) {
-        callback(universes[c]);
-    }
+    // A DDP packet carries more pixel data than a universe, so the universe count bounds it as well
+    Network::instance().setIngestDepth(Network::INGEST_ARTNET, artnet_routes.size());
+    Network::instance().setIngestDepth(Network::INGEST_SACN, e131_routes.size());
+    Network::instance().setIngestDepth(Network::INGEST_DDP, std::max(artnet_routes.size(), e131_routes.size()));
 }
 
-void Control::setArtnetUniverseOutputDataForDriver(size_t terminals, size_t components, uint16_t uni, const uint8_t *data, size_t len) {
+void Control::setUniverseOutputData(const RoutingTable &routes, uint16_t uni, const uint8_t *data, size_t len, uint8_t sequence, bool nodriver) {
     clearStartup();
 
+    bool strip_set[Model::stripN]{};
+    bool strip_complete[Model::stripN]{};
+    bool terminal_set[Driver::terminalN]{};
     rgbww rgb[Driver::terminalN];
-    for (size_t c = 0; c < terminals; c++) {
-        rgb[c] = Driver::instance().srgbwwCIE(c);
-    }
-    for (size_t c = 0; c < terminals; c++) {
-        switch (components) {
-            case 5: {
-                size_t channel = size_t(std::clamp(Model::instance().analogConfig(c).components[4].artnet.channel - 1, 0, 511));
-                if (len > channel) {
-                    if (Model::instance().analogConfig(c).components[4].artnet.universe == uni) {
-                        rgb[c].ww = data[channel];
-                    }
-                }
-            }
-                [[fallthrough]];
-            case 4: {
-                size_t channel = size_t(std::clamp(Model::instance().analogConfig(c).components[3].artnet.channel - 1, 0, 511));
-                if (len > channel) {
-                    if (Model::instance().analogConfig(c).components[3].artnet.universe == uni) {
-                        rgb[c].w = data[channel];
-                    }
-                }
-            }
-                [[fallthrough]];
-            case 3: {
-                size_t channel = size_t(std::clamp(Model::instance().analogConfig(c).components[2].artnet.channel - 1, 0, 511));
-                if (len > channel) {
-                    if (Model::instance().analogConfig(c).components[2].artnet.universe == uni) {
-                        rgb[c].b = data[channel];
-                    }
+
+    for (const Route &route : routes.find(uni)) {
+        switch (route.target) {
+            case Route::STRIP: {
+                Strip &strip = Strip::get(route.index);
+                // Send what arrived of the previous frame before the next one starts overwriting it
+                if (!syncMode && strip.frameUniverseStartsNext(route.slot, sequence)) {
+                    strip.transfer();
                 }
-            }
-                [[fallthrough]];
-            case 2: {
-                size_t channel = size_t(std::clamp(Model::instance().analogConfig(c).components[1].artnet.channel - 1, 0, 511));
-                if (len > channel) {
-                    if (Model::instance().analogConfig(c).components[1].artnet.universe == uni) {
-                        rgb[c].g = data[channel];
-                    }
+                strip.setUniverseData(route.slot, data, len, route.input_type);
+                if (!syncMode) {
+                    strip_complete[route.index] |= strip.frameUniverseArrived(route.slot, sequence, route.input_type);
                 }
-            }
-                [[fallthrough]];
-            case 1: {
-                size_t channel = size_t(std::clamp(Model::instance().analogConfig(c).components[0].artnet.channel - 1, 0, 511));
-                if (len > channel) {
-                    if (Model::instance().analogConfig(c).components[0].artnet.universe == uni) {
-                        rgb[c].r = data[channel];
-                    }
+                strip_set[route.index] = true;
+            } break;
+            case Route::ANALOG: {
+                if (nodriver || len <= route.channel) {
+                    break;
+                }
+                if (!terminal_set[route.index]) {
+                    rgb[route.index] = Driver::instance().srgbwwCIE(route.index);
+                    terminal_set[route.index] = true;
+                }
+                switch (route.slot) {
+                    case 0: {
+                        rgb[route.index].r = data[route.channel];
+                    } break;
+                    case 1: {
+                        rgb[route.index].g = data[route.channel];
+                    } break;
+                    case 2: {
+                        rgb[route.index].b = data[route.channel];
+                    } break;
+                    case 3: {
+                        rgb[route.index].w = data[route.channel];
+                    } break;
+                    case 4: {
+                        rgb[route.index].ww = data[route.channel];
+                    } break;
+                    default: {
+                    } break;
                 }
-            }
-                [[fallthrough]];
-            default:
-            case 0:
-                break;
+            } break;
         }
     }
-    for (size_t c = 0; c < terminals; c++) {
-        Driver::instance().setRGBWW(c, rgb[c]);
-        if (!syncMode) {
-            Driver::instance().sync(c);
+
+    for (size_t c = 0; c < Model::stripN; c++) {
+        if (strip_set[c]) {
+            setDataReceived();
+        }
+        if (strip_complete[c]) {
+            Strip::get(c).transfer();
+        }
+    }
+
+    for (size_t c = 0; c < Driver::terminalN; c++) {
+        if (terminal_set[c]) {
+            Driver::instance().setRGBWW(c, rgb[c]);
+            if (!syncMode) {
+                Driver::instance().sync(c);
+            }
         }
     }
 }
 
-void Control::setE131UniverseOutputDataForDriver(size_t terminals, size_t components, uint16_t uni, const uint8_t *data, size_t len) {
+void Control::setArtnetUniverseOutputData(uint16_t uni, const uint8_t *data, size_t len, uint8_t sequence, bool nodriver) {
+    setUniverseOutputData(artnet_routes, uni, data, len, sequence, nodriver);
+}
+
+void Control::setE131UniverseOutputData(uint16_t uni, const uint8_t *data, size_t len, uint8_t sequence, bool nodriver) {
+    setUniverseOutputData(e131_routes, uni, data, len, sequence, nodriver);
+}
+
+void Control::setDDPData(size_t offset, const uint8_t *data, size_t len) {
     clearStartup();
 
-    rgbww rgb[Driver::terminalN];
-    for (size_t c = 0; c < terminals; c++) {
-        rgb[c] = Driver::instance().srgbwwCIE(c);
-    }
-    for (size_t c = 0; c < terminals; c++) {
-        switch (components) {
-            case 5: {
-                size_t channel = size_t(std::clamp(Model::instance().analogConfig(c).components[4].e131.channel - 1, 0, 511));
-                if (len > channel) {
-                    if (Model::instance().analogConfig(c).components[4].e131.universe == uni) {
-                        rgb[c].ww = data[channel];
-                    }
-                }
-            }
-                [[fallthrough]];
-            case 4: {
-                size_t channel = size_t(std::clamp(Model::instance().analogConfig(c).components[3].e131.channel - 1, 0, 511));
-                if (len > channel) {
-                    if (Model::instance().analogConfig(c).components[3].e131.universe == uni) {
-                        rgb[c].w = data[channel];
-                    }
-                }
-            }
-                [[fallthrough]];
-            case 3: {
-                size_t channel = size_t(std::clamp(Model::instance().analogConfig(c).components[2].e131.channel - 1, 0, 511));
-                if (len > channel) {
-                    if (Model::instance().analogConfig(c).components[2].e131.universe == uni) {
-                        rgb[c].b = data[channel];
-                    }
-                }
-            }
-                [[fallthrough]];
-            case 2: {
-                size_t channel = size_t(std::clamp(Model::instance().analogConfig(c).components[1].e131.channel - 1, 0, 511));
-                if (len > channel) {
-                    if (Model::instance().analogConfig(c).components[1].e131.universe == uni) {
-                        rgb[c].g = data[channel];
-                    }
-                }
-            }
-                [[fallthrough]];
-            case 1: {
-                size_t channel = size_t(std::clamp(Model::instance().analogConfig(c).components[0].e131.channel - 1, 0, 511));
-                if (len > channel) {
-                    if (Model::instance().analogConfig(c).components[0].e131.universe == uni) {
-                        rgb[c].r = data[channel];
-                    }
-                }
-            }
-                [[fallthrough]];
-            default:
-            case 0:
-                break;
+    // DDP addresses one flat byte range; strips are laid out back to back in the configured order
+    size_t base = 0;
+    for (size_t c = 0; c < ddp_strip_count; c++) {
+        const size_t strip = ddp_strips[c];
+        const auto input_type = Model::instance().stripConfig(strip).input_type;
+        const size_t span = Strip::get(strip).getInputLen(input_type);
+        const size_t start = std::max(offset, base);
+        const size_t end = std::min(offset + len, base + span);
+        if (start < end) {
+            Strip::get(strip).setPixelData(start - base, data + (start - offset), end - start, input_type);
+            setDataReceived();
         }
+        base += span;
     }
-    for (size_t c = 0; c < terminals; c++) {
-        Driver::instance().setRGBWW(c, rgb[c]);
-        if (!syncMode) {
-            Driver::instance().sync(c);
-        }
+}
+
+void Control::pushDDP() {
+    for (size_t c = 0; c < ddp_strip_count; c++) {
+        Strip::get(ddp_strips[c]).transfer();
     }
 }
 
-void Control::setArtnetUniverseOutputData(uint16_t uni, const uint8_t *data, size_t len, bool nodriver) {
-    clearStartup();
+void Control::pushDDP(uint32_t timecode) {
+    // Timecode is the low 32 bits of the sender's NTP clock, 16.16 seconds
+    const uint64_t now = Systick::instance().systemTimeRAW();
+    const uint64_t clock = uint64_t(SystemCoreClock);
+    ddp_clock.timecode = ddp_clock.valid ? uint64_t(int64_t(ddp_clock.timecode) + int32_t(timecode - uint32_t(ddp_clock.timecode))) : timecode;
+    const uint64_t sender = (ddp_clock.timecode >> 16) * clock + (((ddp_clock.timecode & 0xFFFF) * clock) >> 16);
+
+    // Track the smallest transit seen, it is the best estimate of the clock offset. Let it creep up
+    // slowly to follow drift, and start over if the sender clock jumps.
+    const int64_t sample = int64_t(now - sender);
+    if (!ddp_clock.valid || sample < ddp_clock.offset || (sample - ddp_clock.offset) > int64_t(clock)) {
+        ddp_clock.offset = sample;
+    } else {
+        ddp_clock.offset += (sample - ddp_clock.offset) >> 6;
+    }
+    ddp_clock.valid = true;
 
-    switch (Model::instance().outputConfig()) {
-        case Model::DUAL_STRIP: {
-            for (size_t c = 0; c < Model::stripN; c++) {
-                bool set = false;
-                for (size_t d = 0; d < Model::universeN; d++) {
-                    if (Model::instance().artnetStrip(c, d) == uni) {
-                        Strip::get(c).setUniverseData(d, data, len, Model::instance().stripConfig(c).input_type);
-                        set = true;
-                    }
-                }
-                if (set) {
-                    setDataReceived();
-                }
-                if (set && !syncMode) {
-                    Strip::get(c).transfer();
-                }
-            }
-        } break;
-        case Model::RGB_DUAL_STRIP: {
-            if (!nodriver) {
-                setArtnetUniverseOutputDataForDriver(1, 3, uni, data, len);
-            }
-            for (size_t c = 0; c < Model::stripN; c++) {
-                bool set = false;
-                for (size_t d = 0; d < Model::universeN; d++) {
-                    if (Model::instance().artnetStrip(c, d) == uni) {
-                        Strip::get(c).setUniverseData(d, data, len, Model::instance().stripConfig(c).input_type);
-                        set = true;
-                    }
-                }
-                if (set) {
-                    setDataReceived();
-                }
-                if (set && !syncMode) {
-                    Strip::get(c).transfer();
-                }
-            }
-        } break;
-        case Model::RGB_STRIP: {
-            if (!nodriver) {
-                setArtnetUniverseOutputDataForDriver(1, 3, uni, data, len);
-            }
-            for (size_t c = 1; c < Model::stripN; c++) {
-                bool set = false;
-                for (size_t d = 0; d < Model::universeN; d++) {
-                    if (Model::instance().artnetStrip(c, d) == uni) {
-                        Strip::get(c).setUniverseData(d, data, len, Model::instance().stripConfig(c).input_type);
-                        set = true;
-                    }
-                }
-                if (set) {
-                    setDataReceived();
-                }
-                if (set && !syncMode) {
-                    Strip::get(c).transfer();
-                }
-            }
-        } break;
-        case Model::RGBW_STRIP: {
-            if (!nodriver) {
-                setArtnetUniverseOutputDataForDriver(1, 4, uni, data, len);
-            }
-            for (size_t c = 1; c < Model::stripN; c++) {
-                bool set = false;
-                for (size_t d = 0; d < Model::universeN; d++) {
-                    if (Model::instance().artnetStrip(c, d) == uni) {
-                        Strip::get(c).setUniverseData(d, data, len, Model::instance().stripConfig(c).input_type);
-                        set = true;
-                    }
-                }
-                if (set) {
-                    setDataReceived();
-                }
-                if (set && !syncMode) {
-                    Strip::get(c).transfer();
-                }
-            }
-        } break;
-        case Model::RGB_RGB: {
-            if (!nodriver) {
-                setArtnetUniverseOutputDataForDriver(Model::analogN, 3, uni, data, len);
-            }
-        } break;
-        case Model::RGBWWW: {
-            if (!nodriver) {
-                setArtnetUniverseOutputDataForDriver(Model::analogN, 5, uni, data, len);
-            }
-        } break;
-        default: {
-        } break;
+    const uint64_t due = uint64_t(int64_t(sender) + ddp_clock.offset) + Systick::msToCycles(Model::instance().ddpPlayoutDelayMs);
+    for (size_t c = 0; c < ddp_strip_count; c++) {
+        Strip::get(ddp_strips[c]).queueFrame(due);
     }
 }
 
-void Control::setE131UniverseOutputData(uint16_t uni, const uint8_t *data, size_t len, bool nodriver) {
-    clearStartup();
+static ULONG ticksUntil(uint64_t now, uint64_t due) {
+    if (due == UINT64_MAX) {
+        return TX_WAIT_FOREVER;
+    }
+    if (Systick::reached(now, due)) {
+        return 1;
+    }
+    const uint64_t cycles_per_tick = SystemCoreClock / TX_TIMER_TICKS_PER_SECOND;
+    return ULONG(std::max(uint64_t(1), (due - now + cycles_per_tick - 1) / cycles_per_tick));
+}
 
-    switch (Model::instance().outputConfig()) {
-        case Model::DUAL_STRIP: {
-            for (size_t c = 0; c < Model::stripN; c++) {
-                bool set = false;
-                for (size_t d = 0; d < Model::universeN; d++) {
-                    if (Model::instance().e131Strip(c, d) == uni) {
-                        Strip::get(c).setUniverseData(d, data, len, Model::instance().stripConfig(c).input_type);
-                        set = true;
-                    }
-                }
-                if (set) {
-                    setDataReceived();
-                }
-                if (set && !syncMode) {
-                    Strip::get(c).transfer();
-                }
-            }
-        } break;
-        case Model::RGB_DUAL_STRIP: {
-            if (!nodriver) {
-                setE131UniverseOutputDataForDriver(1, 3, uni, data, len);
-            }
-            for (size_t c = 0; c < Model::stripN; c++) {
-                bool set = false;
-                for (size_t d = 0; d < Model::universeN; d++) {
-                    if (Model::instance().e131Strip(c, d) == uni) {
-                        Strip::get(c).setUniverseData(d, data, len, Model::instance().stripConfig(c).input_type);
-                        set = true;
-                    }
-                }
-                if (set) {
-                    setDataReceived();
-                }
-                if (set && !syncMode) {
-                    Strip::get(c).transfer();
-                }
-            }
-        } break;
-        case Model::RGB_STRIP: {
-            if (!nodriver) {
-                setE131UniverseOutputDataForDriver(1, 3, uni, data, len);
-            }
-            for (size_t c = 1; c < Model::stripN; c++) {
-                bool set = false;
-                for (size_t d = 0; d < Model::universeN; d++) {
-                    if (Model::instance().e131Strip(c, d) == uni) {
-                        Strip::get(c).setUniverseData(d, data, len, Model::instance().stripConfig(c).input_type);
-                        set = true;
-                    }
-                }
-                if (set) {
-                    setDataReceived();
-                }
-                if (set && !syncMode) {
-                    Strip::get(c).transfer();
-                }
-            }
-        } break;
-        case Model::RGBW_STRIP: {
-            if (!nodriver) {
-                setE131UniverseOutputDataForDriver(1, 4, uni, data, len);
-            }
-            for (size_t c = 1; c < Model::stripN; c++) {
-                bool set = false;
-                for (size_t d = 0; d < Model::universeN; d++) {
-                    if (Model::instance().e131Strip(c, d) == uni) {
-                        Strip::get(c).setUniverseData(d, data, len, Model::instance().stripConfig(c).input_type);
-                        set = true;
-                    }
-                }
-                if (set) {
-                    setDataReceived();
-                }
-                if (set && !syncMode) {
-                    Strip::get(c).transfer();
-                }
-            }
-        } break;
-        case Model::RGB_RGB: {
-            if (!nodriver) {
-                setE131UniverseOutputDataForDriver(Model::analogN, 3, uni, data, len);
-            }
-        } break;
-        case Model::RGBWWW: {
-            if (!nodriver) {
-                setE131UniverseOutputDataForDriver(Model::analogN, 5, uni, data, len);
-            }
+ULONG Control::presentDDP() {
+    const uint64_t now = Systick::instance().systemTimeRAW();
+    uint64_t next = UINT64_MAX;
+    for (size_t c = 0; c < ddp_strip_count; c++) {
+        next = std::min(next, Strip::get(ddp_strips[c]).presentDue(now));
+    }
+    return ticksUntil(now, next);
+}
+
+namespace {
+
+// Hue wheel in 256 steps, built once from the float HSV conversion
+std::array<rgb8, 256> rainbow_palette{};
+
+void buildPalettes() {
+    for (size_t c = 0; c < rainbow_palette.size(); c++) {
+        const rgb8 col(rgb(hsv(float(c) * (1.0f / 256.0f), 1.0f, 1.0f)));
+        rainbow_palette[c] = rgb8(col.red(), col.green(), col.blue());
+    }
+}
+
+// Renders one universe worth of pixels at a time and hands it to the strip's input kernels, which write straight
+// into the component buffer; unchanged universes are skipped by the strip's payload hash.
+template <typename F>
+__attribute__((hot, optimize("O3"))) void renderEffect(size_t strip, F &&pixel) {
+    Strip &s = Strip::get(strip);
+    const size_t cpp = s.getBytesPerPixel();
+    const size_t pixels = s.getPixelLen();
+    const size_t universe_pixels = Strip::dmxMaxLen / cpp;
+    Model::StripConfig::StripInputType input_type = Model::StripConfig::StripInputType::RGB8;
+    switch (cpp) {
+        case 4: {
+            input_type = Model::StripConfig::StripInputType::RGBW8;
+        } break;
+        case 6: {
+            input_type = Model::StripConfig::StripInputType::RGB16_MSB;
         } break;
         default: {
         } break;
     }
+    std::array<uint8_t, Strip::dmxMaxLen> buf;
+    for (size_t first = 0, uniN = 0; first < pixels && uniN < Model::universeN; first += universe_pixels, uniN++) {
+        const size_t count = std::min(universe_pixels, pixels - first);
+        uint8_t *dst = buf.data();
+        for (size_t c = first; c < first + count; c++, dst += cpp) {
+            const rgb8 col = pixel(c);
+            switch (cpp) {
+                case 4: {
+                    dst[0] = col.r;
+                    dst[1] = col.g;
+                    dst[2] = col.b;
+                    dst[3] = col.x;
+                } break;
+                case 6: {
+                    dst[0] = dst[1] = col.r;
+                    dst[2] = dst[3] = col.g;
+                    dst[4] = dst[5] = col.b;
+                } break;
+                default: {
+                    dst[0] = col.r;
+                    dst[1] = col.g;
+                    dst[2] = col.b;
+                } break;
+            }
+        }
+        s.setUniverseData(uniN, buf.data(), count * cpp, input_type);
+    }
+}
+
+void renderColor(size_t strip) {
+    const rgb8 color = Model::instance().stripConfig(strip).color;
+    renderEffect(strip, [color](size_t) { return color; });
 }
 
+}  // namespace
+
 void Control::setColor() {
     for (size_t c = 0; c < Model::stripN; c++) {
-        size_t cpp = Strip::get(c).getBytesPerPixel();
-        size_t len = 0;
-        switch (cpp) {
-            case 3: {
-                for (size_t d = 0; d <= color_buf[c].size() - 3; d += 3) {
-                    color_buf[c][d + 0] = (Model::instance().stripConfig(c).color.r) & 0xFF;
-                    color_buf[c][d + 1] = (Model::instance().stripConfig(c).color.g) & 0xFF;
-                    color_buf[c][d + 2] = (Model::instance().stripConfig(c).color.b) & 0xFF;
-                    len += 3;
-                }
-                Strip::get(c).setData(color_buf[c].data(), len, Model::StripConfig::StripInputType::RGB8);
-            } break;
-            case 4: {
-                for (size_t d = 0; d <= color_buf[c].size() - 4; d += 4) {
-                    color_buf[c][d + 0] = (Model::instance().stripConfig(c).color.r) & 0xFF;
-                    color_buf[c][d + 1] = (Model::instance().stripConfig(c).color.g) & 0xFF;
-                    color_buf[c][d + 2] = (Model::instance().stripConfig(c).color.b) & 0xFF;
-                    color_buf[c][d + 3] = (Model::instance().stripConfig(c).color.x) & 0xFF;
-                    len += 4;
-                }
-                Strip::get(c).setData(color_buf[c].data(), len, Model::StripConfig::StripInputType::RGBW8);
-            } break;
-            case 6: {
-                for (size_t d = 0; d <= color_buf[c].size() - 6; d += 6) {
-                    color_buf[c][d + 0] = color_buf[c][d + 1] = (Model::instance().stripConfig(c).color.r) & 0xFF;
-                    color_buf[c][d + 2] = color_buf[c][d + 3] = (Model::instance().stripConfig(c).color.g) & 0xFF;
-                    color_buf[c][d + 4] = color_buf[c][d + 5] = (Model::instance().stripConfig(c).color.b) & 0xFF;
-                    len += 6;
-                }
-                Strip::get(c).setData(color_buf[c].data(), len, Model::StripConfig::StripInputType::RGB16_MSB);
-            } break;
-        }
+        renderColor(c);
     }
 }
 
-void Control::update() {
+ULONG Control::updateStrips() {
+    const uint64_t now = Systick::instance().systemTimeRAW();
+    uint64_t next = UINT64_MAX;
+
     if (inStartup()) {
-        startupModePattern();
-        sync();
+        if (Systick::reached(now, effect_due)) {
+            effect_due = now + effectPeriod();
+            startupModePattern();
+            sync();
+        }
+        next = effect_due;
     } else if (color_scheduled) {
         color_scheduled = false;
         setColor();
@@ -719,6 +527,19 @@ void Control::update() {
         }
     }
 
+    if (!syncMode) {
+        for (size_t c = 0; c < Model::stripN; c++) {
+            if (Strip::get(c).frameDeadlineExpired()) {
+                Strip::get(c).transfer();
+            }
+            next = std::min(next, Strip::get(c).frameDeadlineDue());
+        }
+    }
+
+    return ticksUntil(now, next);
+}
+
+void Control::update() {
     switch (Model::instance().outputConfig()) {
         case Model::DUAL_STRIP: {
             SPI_0::instance().update();
@@ -729,10 +550,10 @@ void Control::update() {
             SPI_1::instance().update();
         } break;
         case Model::RGB_STRIP: {
-            SPI_0::instance().update();
+            SPI_1::instance().update();
         } break;
         case Model::RGBW_STRIP: {
-            SPI_0::instance().update();
+            SPI_1::instance().update();
         } break;
         case Model::RGB_RGB: {
         } break;
@@ -745,226 +566,58 @@ void Control::update() {
 
 void Control::init() {
     Strip::get(0).dmaTransferFunc = [](const uint8_t *data, size_t len) {
-        SPI_0::instance().transfer(data, len, Strip::get(0).transferMpbs(), Strip::get(0).needsClock());
+        SPI &spi = SPI_0::instance();
+        if (!spi.halfSentFunc) {
+            spi.halfSentFunc = [](size_t half) { Strip::get(0).streamHalfSent(half); };
+            spi.stoppedFunc = []() { Strip::get(0).streamStopped(); };
+        }
+        spi.stream(data, len, Strip::get(0).transferMpbs(), Strip::get(0).needsClock());
     };
-    Strip::get(0).dmaBusyFunc = []() { return SPI_0::instance().isDMAbusy(); };
+    Strip::get(0).dmaStopFunc = []() { SPI_0::instance().stop(); };
 
     Strip::get(1).dmaTransferFunc = [](const uint8_t *data, size_t len) {
-        SPI_1::instance().transfer(data, len, Strip::get(0).transferMpbs(), Strip::get(1).needsClock());
+        SPI &spi = SPI_1::instance();
+        if (!spi.halfSentFunc) {
+            spi.halfSentFunc = [](size_t half) { Strip::get(1).streamHalfSent(half); };
+            spi.stoppedFunc = []() { Strip::get(1).streamStopped(); };
+        }
+        spi.stream(data, len, Strip::get(1).transferMpbs(), Strip::get(1).needsClock());
     };
-    Strip::get(1).dmaBusyFunc = []() { return SPI_1::instance().isDMAbusy(); };
+    Strip::get(1).dmaStopFunc = []() { SPI_1::instance().stop(); };
+
+    buildPalettes();
 
     printf(ESCAPE_FG_CYAN "Control up.\n");
 }
 
 void Control::startupModePattern() {
-    auto effect = [this](size_t strip) {
+    static const rgb8 white(0xFF, 0xFF, 0xFF, 0xFF);
+    static const rgb8 black{};
+
+    auto effect = [](size_t strip) {
         switch (Model::instance().stripConfig(strip).startup_mode) {
             case Model::StripConfig::COLOR: {
-                size_t l = Strip::get(strip).getPixelLen();
-                size_t cpp = Strip::get(strip).getBytesPerPixel();
-                for (size_t c = 0; c < l; c++) {
-                    switch (cpp) {
-                        case 3: {
-                            color_buf[strip][c * 3 + 0] = Model::instance().stripConfig(strip).color.r;
-                            color_buf[strip][c * 3 + 1] = Model::instance().stripConfig(strip).color.g;
-                            color_buf[strip][c * 3 + 2] = Model::instance().stripConfig(strip).color.b;
-                        } break;
-                        case 4: {
-                            color_buf[strip][c * 4 + 0] = Model::instance().stripConfig(strip).color.r;
-                            color_buf[strip][c * 4 + 1] = Model::instance().stripConfig(strip).color.g;
-                            color_buf[strip][c * 4 + 2] = Model::instance().stripConfig(strip).color.b;
-                            color_buf[strip][c * 4 + 3] = Model::instance().stripConfig(strip).color.x;
-                        } break;
-                        case 6: {
-                            color_buf[strip][c * 6 + 0] = color_buf[strip][c * 6 + 1] = (Model::instance().stripConfig(strip).color.r) & 0xFF;
-                            color_buf[strip][c * 6 + 2] = color_buf[strip][c * 6 + 3] = (Model::instance().stripConfig(strip).color.g) & 0xFF;
-                            color_buf[strip][c * 6 + 4] = color_buf[strip][c * 6 + 5] = (Model::instance().stripConfig(strip).color.b) & 0xFF;
-                        } break;
-                    }
-                }
-                switch (cpp) {
-                    default:
-                    case 3:
-                        Strip::get(strip).setData(color_buf[strip].data(), l * cpp, Model::StripConfig::StripInputType::RGB8);
-                        break;
-                    case 4:
-                        Strip::get(strip).setData(color_buf[strip].data(), l * cpp, Model::StripConfig::StripInputType::RGBW8);
-                        break;
-                    case 6:
-                        Strip::get(strip).setData(color_buf[strip].data(), l * cpp, Model::StripConfig::StripInputType::RGB16_MSB);
-                        break;
-                }
+                renderColor(strip);
             } break;
             case Model::StripConfig::RAINBOW: {
-                float h = 1.0f - fmod(float(Systick::instance().systemTime()) / 10.0f, 1.0f);
-                size_t l = Strip::get(strip).getPixelLen();
-                size_t cpp = Strip::get(strip).getBytesPerPixel();
-                for (size_t c = 0; c < l; c++) {
-                    hsv col_hsv(fmod(h + float(c) * (1.0f / 255.0f), 1.0f), 1.0f, 1.0f);
-                    rgb col_rgb(col_hsv);
-                    rgb8 col_rgb8(col_rgb);
-                    switch (cpp) {
-                        case 3: {
-                            color_buf[strip][c * 3 + 0] = col_rgb8.red();
-                            color_buf[strip][c * 3 + 1] = col_rgb8.green();
-                            color_buf[strip][c * 3 + 2] = col_rgb8.blue();
-                        } break;
-                        case 4: {
-                            color_buf[strip][c * 4 + 0] = col_rgb8.red();
-                            color_buf[strip][c * 4 + 1] = col_rgb8.green();
-                            color_buf[strip][c * 4 + 2] = col_rgb8.blue();
-                            color_buf[strip][c * 4 + 3] = 0;
-                        } break;
-                        case 6: {
-                            color_buf[strip][c * 6 + 0] = color_buf[strip][c * 6 + 1] = col_rgb8.red();
-                            color_buf[strip][c * 6 + 2] = color_buf[strip][c * 6 + 3] = col_rgb8.green();
-                            color_buf[strip][c * 6 + 4] = color_buf[strip][c * 6 + 5] = col_rgb8.blue();
-                        } break;
-                    }
-                }
-                switch (cpp) {
-                    default:
-                    case 3:
-                        Strip::get(strip).setData(color_buf[strip].data(), l * cpp, Model::StripConfig::StripInputType::RGB8);
-                        break;
-                    case 4:
-                        Strip::get(strip).setData(color_buf[strip].data(), l * cpp, Model::StripConfig::StripInputType::RGBW8);
-                        break;
-                    case 6:
-                        Strip::get(strip).setData(color_buf[strip].data(), l * cpp, Model::StripConfig::StripInputType::RGB16_MSB);
-                        break;
-                }
+                // Hue runs backwards through the wheel once every 10s, shifted by one palette step per pixel
+                const uint32_t hue = (0x10000 - Systick::instance().phase(10000)) >> 8;
+                renderEffect(strip, [hue](size_t c) { return rainbow_palette[(hue + c) & 0xFF]; });
             } break;
             case Model::StripConfig::TRACER: {
-                float h = 1.0f - fmod(float(Systick::instance().systemTime()) / 5.0f, 1.0f);
-                size_t l = Strip::get(strip).getPixelLen();
-                size_t cpp = Strip::get(strip).getBytesPerPixel();
-                for (size_t c = 0; c < l; c++) {
-                    size_t i = std::clamp(size_t(float(l) * fmod(h + (float(c) / float(l)), 1.0f)), size_t(0), l);
-                    if (i == 0) {
-                        switch (cpp) {
-                            case 3: {
-                                color_buf[strip][c * 3 + 0] = 0xFF;
-                                color_buf[strip][c * 3 + 1] = 0xFF;
-                                color_buf[strip][c * 3 + 2] = 0xFF;
-                            } break;
-                            case 4: {
-                                color_buf[strip][c * 4 + 0] = 0xFF;
-                                color_buf[strip][c * 4 + 1] = 0xFF;
-                                color_buf[strip][c * 4 + 2] = 0xFF;
-                                color_buf[strip][c * 4 + 3] = 0xFF;
-                            } break;
-                            case 6: {
-                                color_buf[strip][c * 6 + 0] = 0xFF;
-                                color_buf[strip][c * 6 + 1] = 0xFF;
-                                color_buf[strip][c * 6 + 2] = 0xFF;
-                                color_buf[strip][c * 6 + 4] = 0xFF;
-                                color_buf[strip][c * 6 + 5] = 0xFF;
-                                color_buf[strip][c * 6 + 6] = 0xFF;
-                            } break;
-                        }
-                    } else {
-                        switch (cpp) {
-                            case 3: {
-                                color_buf[strip][c * 3 + 0] = 0x00;
-                                color_buf[strip][c * 3 + 1] = 0x00;
-                                color_buf[strip][c * 3 + 2] = 0x00;
-                            } break;
-                            case 4: {
-                                color_buf[strip][c * 4 + 0] = 0x00;
-                                color_buf[strip][c * 4 + 1] = 0x00;
-                                color_buf[strip][c * 4 + 2] = 0x00;
-                                color_buf[strip][c * 4 + 3] = 0x00;
-                            } break;
-                            case 6: {
-                                color_buf[strip][c * 6 + 0] = 0x00;
-                                color_buf[strip][c * 6 + 1] = 0x00;
-                                color_buf[strip][c * 6 + 2] = 0x00;
-                                color_buf[strip][c * 6 + 3] = 0x00;
-                                color_buf[strip][c * 6 + 4] = 0x00;
-                                color_buf[strip][c * 6 + 5] = 0x00;
-                            } break;
-                        }
-                    }
-                }
-                switch (cpp) {
-                    default:
-                    case 3:
-                        Strip::get(strip).setData(color_buf[strip].data(), l * cpp, Model::StripConfig::StripInputType::RGB8);
-                        break;
-                    case 4:
-                        Strip::get(strip).setData(color_buf[strip].data(), l * cpp, Model::StripConfig::StripInputType::RGBW8);
-                        break;
-                    case 6:
-                        Strip::get(strip).setData(color_buf[strip].data(), l * cpp, Model::StripConfig::StripInputType::RGB16_MSB);
-                        break;
+                const size_t l = Strip::get(strip).getPixelLen();
+                if (l == 0) {
+                    break;
                 }
+                const size_t head = (l - ((size_t(0x10000 - Systick::instance().phase(5000)) * l) >> 16) % l) % l;
+                renderEffect(strip, [head](size_t c) { return c == head ? white : black; });
             } break;
             case Model::StripConfig::SOLID_TRACER: {
-                float h = 1.0f - fmod(float(Systick::instance().systemTime()) / 5.0f, 1.0f);
-                size_t l = Strip::get(strip).getPixelLen() + 1;
-                size_t cpp = Strip::get(strip).getBytesPerPixel();
-                for (size_t c = 0; c < l; c++) {
-                    size_t i = std::clamp(size_t(float(l) * fmod(h + (float(c) / float(l)), 1.0f)), size_t(0), l);
-                    if (c < i) {
-                        switch (cpp) {
-                            case 3: {
-                                color_buf[strip][c * 3 + 0] = 0xFF;
-                                color_buf[strip][c * 3 + 1] = 0xFF;
-                                color_buf[strip][c * 3 + 2] = 0xFF;
-                            } break;
-                            case 4: {
-                                color_buf[strip][c * 4 + 0] = 0xFF;
-                                color_buf[strip][c * 4 + 1] = 0xFF;
-                                color_buf[strip][c * 4 + 2] = 0xFF;
-                                color_buf[strip][c * 4 + 3] = 0xFF;
-                            } break;
-                            case 6: {
-                                color_buf[strip][c * 6 + 0] = 0xFF;
-                                color_buf[strip][c * 6 + 1] = 0xFF;
-                                color_buf[strip][c * 6 + 2] = 0xFF;
-                                color_buf[strip][c * 6 + 4] = 0xFF;
-                                color_buf[strip][c * 6 + 5] = 0xFF;
-                                color_buf[strip][c * 6 + 6] = 0xFF;
-                            } break;
-                        }
-                    } else {
-                        switch (cpp) {
-                            case 3: {
-                                color_buf[strip][c * 3 + 0] = 0x00;
-                                color_buf[strip][c * 3 + 1] = 0x00;
-                                color_buf[strip][c * 3 + 2] = 0x00;
-                            } break;
-                            case 4: {
-                                color_buf[strip][c * 4 + 0] = 0x00;
-                                color_buf[strip][c * 4 + 1] = 0x00;
-                                color_buf[strip][c * 4 + 2] = 0x00;
-                                color_buf[strip][c * 4 + 3] = 0x00;
-                            } break;
-                            case 6: {
-                                color_buf[strip][c * 6 + 0] = 0x00;
-                                color_buf[strip][c * 6 + 1] = 0x00;
-                                color_buf[strip][c * 6 + 2] = 0x00;
-                                color_buf[strip][c * 6 + 3] = 0x00;
-                                color_buf[strip][c * 6 + 4] = 0x00;
-                                color_buf[strip][c * 6 + 5] = 0x00;
-                            } break;
-                        }
-                    }
-                }
-                switch (cpp) {
-                    default:
-                    case 3:
-                        Strip::get(strip).setData(color_buf[strip].data(), l * cpp, Model::StripConfig::StripInputType::RGB8);
-                        break;
-                    case 4:
-                        Strip::get(strip).setData(color_buf[strip].data(), l * cpp, Model::StripConfig::StripInputType::RGBW8);
-                        break;
-                    case 6:
-                        Strip::get(strip).setData(color_buf[strip].data(), l * cpp, Model::StripConfig::StripInputType::RGB16_MSB);
-                        break;
-                }
+                // One position past the end so the strip is fully dark for a step of every cycle
+                const size_t l = Strip::get(strip).getPixelLen() + 1;
+                const size_t pos = ((size_t(0x10000 - Systick::instance().phase(5000)) * l) >> 16) % l;
+                const size_t lit = pos ? l - pos : 0;
+                renderEffect(strip, [lit](size_t c) { return c < lit ? white : black; });
             } break;
             case Model::StripConfig::NODATA: {
             } break;
@@ -991,4 +644,13 @@ void Control::startupModePattern() {
     }
 }
 
+uint64_t Control::effectPeriod() const {
+    // No faster than the configured rate, and never faster than the slowest strip can clock a frame out
+    uint64_t period = Systick::msToCycles(1000) / std::max(Model::instance().startupFps, uint32_t(1));
+    for (size_t c = 0; c < Model::stripN; c++) {
+        period = std::max(period, uint64_t(Strip::get(c).wireTimeUs()) * Systick::cyclesPerMS() / 1000);
+    }
+    return period;
+}
+
 #endif  // #ifndef BOOTLOADER
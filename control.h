@@ -23,7 +23,9 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #ifndef CONTROL_H
 #define CONTROL_H
 
-#include <functional>
+#include <array>
+#include <atomic>
+#include <span>
 
 #include "./model.h"
 #include "./strip.h"
@@ -39,8 +41,15 @@ class Control {
     bool start();
     void thread();
 
-    void setArtnetUniverseOutputData(uint16_t universe, const uint8_t *data, size_t len, bool nodriver = false);
-    void setE131UniverseOutputData(uint16_t universe, const uint8_t *data, size_t len, bool nodriver = false);
+    void setArtnetUniverseOutputData(uint16_t universe, const uint8_t *data, size_t len, uint8_t sequence = 0, bool nodriver = false);
+    void setE131UniverseOutputData(uint16_t universe, const uint8_t *data, size_t len, uint8_t sequence = 0, bool nodriver = false);
+    void setDDPData(size_t offset, const uint8_t *data, size_t len);
+    void pushDDP();
+    void pushDDP(uint32_t timecode);
+    ULONG presentDDP();
+    ULONG updateStrips();
+
+    void buildRoutes();
 
     void sync();
     void update();
@@ -52,9 +61,9 @@ class Control {
     void setEnableSyncMode(bool state) { syncMode = state; }
     bool syncModeEnabled() const { return syncMode; }
 
-    void interateAllActiveArtnetUniverses(std::function<void(uint16_t universe)> callback);
-    void collectAllActiveArtnetUniverses(std::array<uint16_t, Model::maxUniverses> &universes, size_t &universeCount);
-    void collectAllActiveE131Universes(std::array<uint16_t, Model::maxUniverses> &universes, size_t &universeCount);
+    // Copies the sorted, unique universe set last published by buildRoutes(); safe from any thread
+    size_t activeArtnetUniverses(std::span<uint16_t> out) const { return artnet_routes.copyActive(out); }
+    size_t activeE131Universes(std::span<uint16_t> out) const { return e131_routes.copyActive(out); }
 
     void setDataReceived() { data_received = true; }
     bool dataReceived() const { return data_received; }
@@ -64,15 +73,67 @@ class Control {
     void startupModePattern();
 
    private:
-    std::array<uint8_t, Strip::bytesMaxLen> color_buf[Model::stripN] {};
+    struct Route {
+        enum Target : uint8_t { STRIP, ANALOG };
+        Target target;
+        uint8_t index;
+        uint8_t slot;
+        Model::StripConfig::StripInputType input_type;
+        uint16_t channel;
+    };
+
+    class RoutingTable {
+       public:
+        void clear();
+        void add(uint16_t universe, const Route &route);
+        void compile();
+        std::span<const Route> find(uint16_t universe) const;
+        size_t copyActive(std::span<uint16_t> out) const;
+        size_t size() const { return route_count; }
+
+       private:
+        static constexpr size_t bucketN = 128;
+        static_assert(bucketN >= Model::maxUniverses && (bucketN & (bucketN - 1)) == 0);
+
+        struct Bucket {
+            uint16_t universe;
+            uint8_t first;
+            uint8_t count;
+        };
+
+        std::array<uint16_t, Model::maxUniverses> universes{};
+        std::array<Route, Model::maxUniverses> routes{};
+        std::array<Bucket, bucketN> buckets{};
+        size_t route_count = 0;
+
+        // compile() fills the set readers are not looking at, then flips the generation to publish it
+        struct ActiveSet {
+            std::array<uint16_t, Model::maxUniverses> universes{};
+            size_t count = 0;
+        };
+        std::array<ActiveSet, 2> active_sets{};
+        std::atomic<uint32_t> active_generation{0};
+    };
+
+    RoutingTable artnet_routes{};
+    RoutingTable e131_routes{};
+
+    std::array<uint8_t, Model::stripN> ddp_strips{};
+    size_t ddp_strip_count = 0;
+    struct DDPClock {
+        int64_t offset = 0;
+        uint64_t timecode = 0;
+        bool valid = false;
+    } ddp_clock{};
 
     bool in_startup = true;
     bool color_scheduled = false;
     bool data_received = false;
     bool syncMode = false;
+    uint64_t effect_due = 0;
+    uint64_t effectPeriod() const;
     //    void setColor(size_t strip, size_t index, const rgb8 &color);
-    void setArtnetUniverseOutputDataForDriver(size_t channels, size_t components, uint16_t uni, const uint8_t *data, size_t len);
-    void setE131UniverseOutputDataForDriver(size_t channels, size_t components, uint16_t uni, const uint8_t *data, size_t len);
+    void setUniverseOutputData(const RoutingTable &routes, uint16_t uni, const uint8_t *data, size_t len, uint8_t sequence, bool nodriver);
     bool initialized = false;
     void init();
 
@@ -59,6 +59,7 @@ enum {
     DDP_FLAGS1_STORAGE = 0x08,
     DDP_FLAGS1_TIMECODE = 0x10,
     DDP_FLAGS1_VER1 = 0x40,
+    DDP_FLAGS1_VER_MASK = 0xC0,
 };
 
 enum { DDP_ID_DISPLAY = 1, DDP_ID_CONTROL = 246, DDP_ID_CONFIG = 250, DDP_ID_STATUS = 251, DDP_ID_DMX = 254, DDP_ID_ALL = 255 };
@@ -68,11 +69,25 @@ class DDPDataPacketSet : public DDPPacket {
     DDPDataPacketSet(){};
     virtual ~DDPDataPacketSet(){};
 
-    void apply(){};
+    void apply() const {
+        const size_t header = (packet[0] & DDP_FLAGS1_TIMECODE) ? 14 : 10;
+        const size_t offset = (size_t(packet[4]) << 24) | (size_t(packet[5]) << 16) | (size_t(packet[6]) << 8) | (size_t(packet[7]) << 0);
+        const size_t len = (size_t(packet[8]) << 8) | (size_t(packet[9]) << 0);
+        Control::instance().setDDPData(offset, packet.data() + header, len);
+        if ((packet[0] & DDP_FLAGS1_PUSH) == 0) {
+            return;
+        }
+        if ((packet[0] & DDP_FLAGS1_TIMECODE) != 0) {
+            const uint32_t timecode = (uint32_t(packet[10]) << 24) | (uint32_t(packet[11]) << 16) | (uint32_t(packet[12]) << 8) | (uint32_t(packet[13]) << 0);
+            Control::instance().pushDDP(timecode);
+        } else {
+            Control::instance().pushDDP();
+        }
+    }
 
    private:
     virtual bool verify() const override {
-        if (packet[0] != DDP_FLAGS1_VER1) {
+        if ((packet[0] & (DDP_FLAGS1_VER_MASK | DDP_FLAGS1_REPLY | DDP_FLAGS1_QUERY)) != DDP_FLAGS1_VER1) {
             return false;
         }
         if (packet[3] != DDP_ID_DISPLAY) {
@@ -350,6 +365,8 @@ class DDPAllQueryPacket : public DDPPacket {
     virtual bool verify() const override { return true; }
 };
 
+ULONG DDPPacket::present() { return Control::instance().presentDDP(); }
+
 bool DDPPacket::dispatch(const NXD_ADDRESS *from, const uint8_t *buf, size_t len, bool isBroadcast) {
     (void)from;
     PacketType type = DDPPacket::maybeValid(buf, len);
@@ -456,7 +473,7 @@ DDPPacket::PacketType DDPPacket::maybeValid(const uint8_t *buf, size_t len) {
         return PacketInvalid;
     }
     if ((buf[0] & DDP_FLAGS1_QUERY) != 0) {
-        switch (buf[2]) {
+        switch (buf[3]) {
             case DDP_ID_DISPLAY:
                 return PacketDataQuery;
             case DDP_ID_STATUS:
@@ -471,7 +488,7 @@ DDPPacket::PacketType DDPPacket::maybeValid(const uint8_t *buf, size_t len) {
                 return PacketAllQuery;
         }
     } else {
-        switch (buf[2]) {
+        switch (buf[3]) {
             case DDP_ID_DISPLAY:
                 return PacketDataSet;
             case DDP_ID_STATUS:
@@ -494,7 +511,7 @@ bool DDPPacket::verify(DDPPacket &packet, const uint8_t *buf, size_t len) {  //
     if (type == PacketInvalid) {
         return false;
     }
-    memcpy(packet.packet.data(), buf, std::min(len, packet.packet.size()));
+    packet.packet = std::span<const uint8_t>(buf, len);
     switch (type) {
         case PacketDataSet:
         case PacketDataQuery:
@@ -26,6 +26,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <stdint.h>
 
 #include <array>
+#include <span>
 
 #include "nx_api.h"
 
@@ -51,12 +52,13 @@ class DDPPacket {
     };
 
     static bool dispatch(const NXD_ADDRESS *from, const uint8_t *buf, size_t len, bool isBroadcast);
+    static ULONG present();
 
    protected:
     DDPPacket(){};
     virtual ~DDPPacket(){};
     virtual bool verify() const { return false; }
-    std::array<uint8_t, maxDDPPacketSize> packet{};
+    std::span<const uint8_t> packet{};
 
    private:
     static PacketType maybeValid(const uint8_t *buf, size_t len);
@@ -0,0 +1,151 @@
+/*
+Copyright 2023 Tinic Uro
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "./merge.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "stm32h5xx_hal.h"
+
+#ifndef BOOTLOADER
+
+// Per byte 0xFF where a >= b. Mirrors the GE flags USUB8 leaves behind for SEL.
+static constexpr uint32_t ge8(uint32_t a, uint32_t b) {
+    const uint32_t d = (a | 0x80808080) - (b & 0x7F7F7F7F);
+    const uint32_t h = ((a & ~b) | (~(a ^ b) & d)) & 0x80808080;
+    return (h >> 7) * 0xFF;
+}
+
+static constexpr uint32_t sel8(uint32_t mask, uint32_t a, uint32_t b) { return (a & mask) | (b & ~mask); }
+
+static constexpr bool ge8_exact() {
+    for (uint32_t a = 0; a < 256; a++) {
+        for (uint32_t b = 0; b < 256; b++) {
+            const uint32_t m = ge8(a | (b << 8) | 0x00FF0000, b | (a << 8) | 0xFF000000);
+            if (((m >> 0) & 0xFF) != (a >= b ? 0xFFU : 0x00U) || ((m >> 8) & 0xFF) != (b >= a ? 0xFFU : 0x00U) || ((m >> 16) & 0xFF) != 0xFF ||
+                ((m >> 24) & 0xFF) != 0x00) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+static_assert(ge8_exact());
+
+static inline uint32_t load(const uint8_t *p) {
+    uint32_t w = 0;
+    memcpy(&w, p, sizeof(w));
+    return w;
+}
+
+static inline void store(uint8_t *p, uint32_t w) { memcpy(p, &w, sizeof(w)); }
+
+__attribute__((hot, optimize("O3"))) void Merge::htp(uint8_t *dst, const uint8_t *a, const uint8_t *b, size_t len) {
+    size_t c = 0;
+    for (; c + 4 <= len; c += 4) {
+        const uint32_t wa = load(&a[c]);
+        const uint32_t wb = load(&b[c]);
+#ifdef __ARM_FEATURE_DSP
+        __USUB8(wa, wb);
+        store(&dst[c], __SEL(wa, wb));
+#else
+        store(&dst[c], sel8(ge8(wa, wb), wa, wb));
+#endif  // #ifdef __ARM_FEATURE_DSP
+    }
+    for (; c < len; c++) {
+        dst[c] = std::max(a[c], b[c]);
+    }
+}
+
+__attribute__((hot, optimize("O3"))) void Merge::htp(uint8_t *dst, uint8_t *keep, const uint8_t *a, const uint8_t *b, size_t len) {
+    size_t c = 0;
+    for (; c + 4 <= len; c += 4) {
+        const uint32_t wa = load(&a[c]);
+        const uint32_t wb = load(&b[c]);
+        store(&keep[c], wa);
+#ifdef __ARM_FEATURE_DSP
+        __USUB8(wa, wb);
+        store(&dst[c], __SEL(wa, wb));
+#else
+        store(&dst[c], sel8(ge8(wa, wb), wa, wb));
+#endif  // #ifdef __ARM_FEATURE_DSP
+    }
+    for (; c < len; c++) {
+        keep[c] = a[c];
+        dst[c] = std::max(a[c], b[c]);
+    }
+}
+
+__attribute__((hot, optimize("O3"))) void Merge::prioritized(uint8_t *dst, uint8_t *dst_prio, const uint8_t *src, const uint8_t *src_prio, size_t len,
+                                                             bool htp) {
+    size_t c = 0;
+    for (; c + 4 <= len; c += 4) {
+        const uint32_t d = load(&dst[c]);
+        const uint32_t dp = load(&dst_prio[c]);
+        const uint32_t s = load(&src[c]);
+        const uint32_t sp = load(&src_prio[c]);
+#ifdef __ARM_FEATURE_DSP
+        uint32_t tie = d;
+        if (htp) {
+            __USUB8(d, s);
+            const uint32_t mx = __SEL(d, s);
+            __USUB8(sp, dp);
+            tie = __SEL(mx, d);
+        }
+        __USUB8(dp, sp);
+        store(&dst[c], __SEL(tie, s));
+        store(&dst_prio[c], __SEL(dp, sp));
+#else
+        const uint32_t keep = ge8(dp, sp);
+        const uint32_t tie = htp ? sel8(ge8(sp, dp), sel8(ge8(d, s), d, s), d) : d;
+        store(&dst[c], sel8(keep, tie, s));
+        store(&dst_prio[c], sel8(keep, dp, sp));
+#endif  // #ifdef __ARM_FEATURE_DSP
+    }
+    for (; c < len; c++) {
+        if (src_prio[c] > dst_prio[c]) {
+            dst[c] = src[c];
+            dst_prio[c] = src_prio[c];
+        } else if (htp && src_prio[c] == dst_prio[c]) {
+            dst[c] = std::max(dst[c], src[c]);
+        }
+    }
+}
+
+__attribute__((hot, optimize("O3"))) void Merge::release(uint8_t *dst, const uint8_t *src, const uint8_t *prio, size_t len) {
+    size_t c = 0;
+    for (; c + 4 <= len; c += 4) {
+#ifdef __ARM_FEATURE_DSP
+        __USUB8(0, load(&prio[c]));
+        store(&dst[c], __SEL(0, load(&src[c])));
+#else
+        store(&dst[c], sel8(ge8(0, load(&prio[c])), 0, load(&src[c])));
+#endif  // #ifdef __ARM_FEATURE_DSP
+    }
+    for (; c < len; c++) {
+        dst[c] = prio[c] ? src[c] : 0;
+    }
+}
+
+#endif  // #ifndef BOOTLOADER
@@ -0,0 +1,49 @@
+/*
+Copyright 2023 Tinic Uro
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#ifndef _MERGE_H_
+#define _MERGE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef BOOTLOADER
+
+// DMX merge kernels, four slots per step
+class Merge {
+   public:
+    // dst = max(a, b)
+    static void htp(uint8_t *dst, const uint8_t *a, const uint8_t *b, size_t len);
+    // dst = max(a, b) and keep = a in the same pass
+    static void htp(uint8_t *dst, uint8_t *keep, const uint8_t *a, const uint8_t *b, size_t len);
+
+    // Folds src into dst slot by slot: the higher priority wins, equal priorities take the higher level when htp is set and keep dst otherwise.
+    // dst_prio is updated to the winning priority.
+    static void prioritized(uint8_t *dst, uint8_t *dst_prio, const uint8_t *src, const uint8_t *src_prio, size_t len, bool htp);
+
+    // dst = src, with every slot nobody sources (priority 0) zeroed
+    static void release(uint8_t *dst, const uint8_t *src, const uint8_t *prio, size_t len);
+};
+
+#endif  // #ifndef BOOTLOADER
+
+#endif  // #ifndef _MERGE_H_
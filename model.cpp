@@ -27,6 +27,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <string>
 #include <vector>
 
+#include "./artnet.h"
 #include "./control.h"
 #include "./driver.h"
 #include "./settingsdb.h"
@@ -263,8 +264,28 @@ void Model::exportToDB() {
         SettingsDB::instance().setBool(SettingsDB::kBroadcastEnabled, broadcastEnabled);
     }
 
-    if (!SettingsDB::instance().hasBool(SettingsDB::kBurstModeEnabled)) {
-        SettingsDB::instance().setBool(SettingsDB::kBurstModeEnabled, burstMode);
+    if (!SettingsDB::instance().hasBool(SettingsDB::kMergeLTP)) {
+        SettingsDB::instance().setBool(SettingsDB::kMergeLTP, mergeLTP);
+    }
+
+    if (!SettingsDB::instance().hasNumber(SettingsDB::kFrameDeadline)) {
+        SettingsDB::instance().setNumber(SettingsDB::kFrameDeadline, float(frameDeadlineMs));
+    }
+
+    if (!SettingsDB::instance().hasNumber(SettingsDB::kDDPPlayoutDelay)) {
+        SettingsDB::instance().setNumber(SettingsDB::kDDPPlayoutDelay, float(ddpPlayoutDelayMs));
+    }
+
+    if (!SettingsDB::instance().hasNumber(SettingsDB::kStartupFps)) {
+        SettingsDB::instance().setNumber(SettingsDB::kStartupFps, float(startupFps));
+    }
+
+    if (!SettingsDB::instance().hasNumberVector(SettingsDB::kDDPStripOrder)) {
+        nvec.clear();
+        for (auto strip : ddpStripOrder) {
+            nvec.push_back(float(strip));
+        }
+        SettingsDB::instance().setNumberVector(SettingsDB::kDDPStripOrder, nvec);
     }
 
     if (!SettingsDB::instance().hasString(SettingsDB::kOutputConfig)) {
@@ -312,6 +333,14 @@ void Model::exportToDB() {
         SettingsDB::instance().setNumberVector(SettingsDB::kStripLedCount, nvec);
     }
 
+    if (!SettingsDB::instance().hasNumberVector(SettingsDB::kStripNrzBits)) {
+        nvec.clear();
+        for (auto config : strip_config) {
+            nvec.push_back(float(config.nrz_bits));
+        }
+        SettingsDB::instance().setNumberVector(SettingsDB::kStripNrzBits, nvec);
+    }
+
     if (!SettingsDB::instance().hasNumberVector2D(SettingsDB::kStripArtnetUniverse)) {
         dvec.clear();
         for (auto config : strip_config) {
@@ -424,9 +453,54 @@ bool Model::importFromDB() {
     }
 
     {
-        bool bm = false;
-        if (SettingsDB::instance().getBool(SettingsDB::kBurstModeEnabled, &bm)) {
-            burstMode = bm;
+        bool ltp = false;
+        if (SettingsDB::instance().getBool(SettingsDB::kMergeLTP, &ltp)) {
+            mergeLTP = ltp;
+        }
+    }
+
+    {
+        float fd = 0;
+        if (SettingsDB::instance().getNumber(SettingsDB::kFrameDeadline, &fd)) {
+            if ((fd < 0.0f) || (fd > 1000.0f)) {
+                return false;
+            }
+            frameDeadlineMs = uint32_t(fd);
+        }
+    }
+
+    {
+        float pd = 0;
+        if (SettingsDB::instance().getNumber(SettingsDB::kDDPPlayoutDelay, &pd)) {
+            if ((pd < 0.0f) || (pd > 1000.0f)) {
+                return false;
+            }
+            ddpPlayoutDelayMs = uint32_t(pd);
+        }
+    }
+
+    {
+        float fps = 0;
+        if (SettingsDB::instance().getNumber(SettingsDB::kStartupFps, &fps)) {
+            if ((fps < 1.0f) || (fps > 1000.0f)) {
+                return false;
+            }
+            startupFps = uint32_t(fps);
+        }
+    }
+
+    if (SettingsDB::instance().getNumberVector(SettingsDB::kDDPStripOrder, nvec)) {
+        if (nvec.size() >= stripN) {
+            uint32_t seen = 0;
+            for (size_t c = 0; c < stripN; c++) {
+                if ((nvec[c] < 0.0f) || (nvec[c] >= float(stripN)) || (seen & (1U << size_t(nvec[c])))) {
+                    return false;
+                }
+                seen |= 1U << size_t(nvec[c]);
+                ddpStripOrder[c] = uint8_t(nvec[c]);
+            }
+        } else {
+            return false;
         }
     }
 
@@ -528,6 +602,19 @@ bool Model::importFromDB() {
         }
     }
 
+    if (SettingsDB::instance().getNumberVector(SettingsDB::kStripNrzBits, nvec)) {
+        if (nvec.size() >= stripN) {
+            for (size_t c = 0; c < stripN; c++) {
+                if ((nvec[c] != 3.0f) && (nvec[c] != 4.0f)) {
+                    return false;
+                }
+                strip_config[c].nrz_bits = uint8_t(nvec[c]);
+            }
+        } else {
+            return false;
+        }
+    }
+
     if (SettingsDB::instance().getNumberVector2D(SettingsDB::kStripArtnetUniverse, dvec)) {
         if (svec.size() >= stripN) {
             for (size_t c = 0; c < stripN; c++) {
@@ -699,7 +786,10 @@ void Model::applyToControl() {
         Strip::get(c).setRGBColorSpace(strip_config[c].rgbSpace);
         Strip::get(c).setCompLimit(strip_config[c].comp_limit);
         Strip::get(c).setGlobIllum(strip_config[c].glob_illum);
-        Strip::get(c).setTransferMbps(uint32_t(float(strip_config[c].mbps) * stripOutputProperties[strip_config[c].output_type].spi_mpbs_factor));
+        Strip::get(c).setNrzBits(strip_config[c].nrz_bits);
+        float spi_mpbs_factor = Strip::get(c).nrz3Bit() ? 3.0f : stripOutputProperties[strip_config[c].output_type].spi_mpbs_factor;
+        Strip::get(c).setTransferMbps(uint32_t(float(strip_config[c].mbps) * spi_mpbs_factor));
+        Strip::get(c).setFrameDeadline(frameDeadlineMs);
     }
 
     for (size_t c = 0; c < analogN; c++) {
@@ -714,6 +804,10 @@ void Model::applyToControl() {
         Driver::instance().setPWMLimit(c, analog_config[c].pwm_limit);
     }
 
+    Control::instance().buildRoutes();
+
+    ArtPollResponder::instance().invalidate();
+
     Control::instance().setColor();
 
     Control::instance().sync();
@@ -50,7 +50,11 @@ struct Model {
     static constexpr size_t maxUniverseID = 65535;
 
     bool broadcastEnabled = false;
-    bool burstMode = false;
+    uint32_t frameDeadlineMs = 10;
+    uint8_t ddpStripOrder[stripN] = {0, 1};
+    uint32_t ddpPlayoutDelayMs = 20;
+    bool mergeLTP = false;
+    uint32_t startupFps = 60;
 
     struct AnalogConfig {
         // clang-format off
@@ -163,16 +167,17 @@ struct Model {
         RGBColorSpace rgbSpace;
         uint16_t artnet[universeN];
         uint16_t e131[universeN];
+        uint8_t nrz_bits;
     } strip_config[stripN] = {
-        {StripConfig::HD108, StripConfig::RGB8, StripConfig::RAINBOW, 1.0, 1.0, 255, 20000000, rgb8(), RGBColorSpace(), {0, 0, 0, 0, 0, 0}, {1, 0, 0, 0, 0, 0}},
-        {StripConfig::HD108, StripConfig::RGB8, StripConfig::RAINBOW, 1.0, 1.0, 255, 20000000, rgb8(), RGBColorSpace(), {1, 0, 0, 0, 0, 0}, {2, 0, 0, 0, 0, 0}},
+        {StripConfig::HD108, StripConfig::RGB8, StripConfig::RAINBOW, 1.0, 1.0, 255, 20000000, rgb8(), RGBColorSpace(), {0, 0, 0, 0, 0, 0}, {1, 0, 0, 0, 0, 0}, 4},
+        {StripConfig::HD108, StripConfig::RGB8, StripConfig::RAINBOW, 1.0, 1.0, 255, 20000000, rgb8(), RGBColorSpace(), {1, 0, 0, 0, 0, 0}, {2, 0, 0, 0, 0, 0}, 4},
     };
 
     // clang-format off
     static constexpr struct StripInputProperties {
         StripConfig::StripInputType type;
-        uint8_t bytes_per_comp;
         uint8_t bytes_per_pixel;
+        uint8_t bytes_per_comp;
         uint8_t comp_per_pixel;
     } stripInputProperties[magic_enum::enum_count<StripConfig::StripInputType>()] = {
         { StripConfig::RGB8,       3, 1, 3 },
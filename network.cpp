@@ -24,11 +24,14 @@ SOFTWARE.
 #include "network.h"
 
 #ifndef BOOTLOADER
+#include <algorithm>
 #include <emio/format.hpp>
 #endif  // #ifndef BOOTLOADER
 
 #include "./artnet.h"
+#include "./control.h"
 #include "./ddp.h"
+#include "./model.h"
 #include "./sacn.h"
 #include "./settingsdb.h"
 #include "./support/ipv6.h"
@@ -36,7 +39,19 @@ SOFTWARE.
 #include "./utils.h"
 #include "stm32h5xx_hal.h"
 
+#ifndef BOOTLOADER
+static_assert(Network::ingestMaxDepth >= Model::maxUniverses);
+
+// The ingest ring pins at most ingestMaxDepth packets. Add the RX descriptors, the replies waiting on TX descriptors and
+// a few ARP/IGMP/DHCP packets. That is the reserve. TCP may hold packets only while the pool stays above the reserve,
+// so on top of it the pool has room for one full TCP receive queue.
+#define NX_PACKET_POOL_RESERVE (Network::ingestMaxDepth + ETH_RX_DESC_CNT + ETH_TX_DESC_CNT + 4)
+#define NX_PACKET_POOL_SIZE ((ETH_MAX_PACKET_SIZE + sizeof(NX_PACKET)) * (NX_PACKET_POOL_RESERVE + NX_TCP_MAXIMUM_RX_QUEUE))
+// HTTP, mDNS and DHCPv6 transmit from their own pool so a busy UI cannot drain the receive pool.
+#define NX_WEB_PACKET_POOL_SIZE ((ETH_MAX_PACKET_SIZE + sizeof(NX_PACKET)) * 16)
+#else   // #ifndef BOOTLOADER
 #define NX_PACKET_POOL_SIZE (ETH_MAX_PACKET_SIZE * 32)
+#endif  // #ifndef BOOTLOADER
 
 Network &Network::instance() {
     static Network network;
@@ -218,23 +233,113 @@ bool Network::AddrToString(const NXD_ADDRESS *value, char *ip_str, size_t max_le
     return false;
 }
 
-static void artnet_receive_notify(NX_UDP_SOCKET *socket_ptr) { Network::instance().ArtNetReceive(socket_ptr); }
+void thread_ingest_entry(ULONG thread_input) {
+    NX_PARAMETER_NOT_USED(thread_input);
+    Network::instance().ingest();
+    tx_thread_relinquish();
+}
 
-void Network::ArtNetReceive(NX_UDP_SOCKET *socket_ptr) {
+void Network::ingestPush(NX_UDP_SOCKET *socket_ptr, IngestProtocol protocol) {
     NX_PACKET *packet_ptr = 0;
+    bool pushed = false;
     while (nx_udp_socket_receive(socket_ptr, &packet_ptr, NX_NO_WAIT) == NX_SUCCESS) {
-        NXD_ADDRESS recvAddr{};
-        UINT status = nxd_udp_packet_info_extract(packet_ptr, &recvAddr, NULL, NULL, NULL);
-        if (status != NX_SUCCESS) {
-            return;
+        uint32_t head = ingest_head.load(std::memory_order_relaxed);
+        size_t used = size_t(head - ingest_tail.load(std::memory_order_acquire));
+        if (used >= ingestMaxDepth || ingest_inflight[protocol].load(std::memory_order_relaxed) >= ingest_depth[protocol]) {
+            nx_packet_release(packet_ptr);
+            ingest_drops[protocol]++;
+            continue;
+        }
+        ingest_ring[head & (ingestRingSize - 1)] = {packet_ptr, protocol};
+        ingest_inflight[protocol].fetch_add(1, std::memory_order_relaxed);
+        ingest_head.store(head + 1, std::memory_order_release);
+        ingest_high_water = std::max(ingest_high_water, used + 1);
+        pushed = true;
+    }
+    samplePools();
+    if (pushed) {
+        tx_event_flags_set(&ingest_flags, ingestPending, TX_OR);
+    }
+}
+
+void Network::samplePools() {
+    rx_pool_low = std::min(rx_pool_low, client_pool.nx_packet_pool_available);
+    web_pool_low = std::min(web_pool_low, web_pool.nx_packet_pool_available);
+}
+
+void Network::ingestDispatch(const IngestEntry &entry) {
+    NX_PACKET *packet_ptr = entry.packet;
+    NXD_ADDRESS recvAddr{};
+    if (nxd_udp_packet_info_extract(packet_ptr, &recvAddr, NULL, NULL, NULL) == NX_SUCCESS) {
+        const uint8_t *buf = packet_ptr->nx_packet_prepend_ptr;
+        size_t len = size_t(packet_ptr->nx_packet_append_ptr - packet_ptr->nx_packet_prepend_ptr);
+        switch (entry.protocol) {
+            case INGEST_ARTNET: {
+                ArtNetPacket::dispatch(&recvAddr, buf, len, AddrIsBroadcast(&recvAddr));
+            } break;
+            case INGEST_SACN: {
+                sACNPacket::dispatch(&recvAddr, buf, len, AddrIsBroadcast(&recvAddr));
+            } break;
+            case INGEST_DDP: {
+                DDPPacket::dispatch(&recvAddr, buf, len, AddrIsBroadcast(&recvAddr));
+            } break;
+            case INGEST_PROTOCOL_COUNT: {
+            } break;
+        }
+    }
+    nx_packet_release(packet_ptr);
+}
+
+size_t Network::ingestDrain() {
+    size_t count = 0;
+    uint32_t tail = ingest_tail.load(std::memory_order_relaxed);
+    while (count < ingestBatchSize && tail != ingest_head.load(std::memory_order_acquire)) {
+        IngestEntry entry = ingest_ring[tail & (ingestRingSize - 1)];
+        ingest_tail.store(++tail, std::memory_order_release);
+        ingestDispatch(entry);
+        ingest_inflight[entry.protocol].fetch_sub(1, std::memory_order_relaxed);
+        count++;
+    }
+    return count;
+}
+
+void Network::setIngestDepth(IngestProtocol protocol, size_t universes) {
+    // Room for one and a half frames so a controller running slightly ahead is absorbed
+    ingest_depth[protocol] = uint16_t(std::clamp(universes + universes / 2, ingestMinDepth, ingestMaxDepth));
+}
+
+void Network::ingest() {
+    ULONG wait = TX_WAIT_FOREVER;
+    while (1) {
+        ULONG flags = 0;
+        tx_event_flags_get(&ingest_flags, ingestPending | ingestReconfigure | ingestTimeouts | ingestColor, TX_OR_CLEAR, &flags, wait);
+        // New settings are applied between packets, so routes never change under a universe being written
+        if (flags & ingestReconfigure) {
+            Model::instance().applyToControl();
+            sACNPacket::updateNetworks();
+            ArtNetPacket::updateUniverses();
         }
-        const uint8_t *artnetBuf = packet_ptr->nx_packet_prepend_ptr;
-        size_t artnetLen = size_t(packet_ptr->nx_packet_append_ptr - packet_ptr->nx_packet_prepend_ptr);
-        ArtNetPacket::dispatch(&recvAddr, artnetBuf, artnetLen, AddrIsBroadcast(&recvAddr));
-        nx_packet_release(packet_ptr);
+        if (flags & ingestTimeouts) {
+            ArtNetPacket::checkTimeouts();
+        }
+        if (flags & ingestColor) {
+            Control::instance().scheduleColor();
+        }
+        // Only the IP thread outranks ingest, so the HTTP server and DHCP wait until the ring is drained.
+        // Relinquishing between batches still lets any other thread at this priority in during long bursts.
+        while (ingestDrain() == ingestBatchSize) {
+            tx_thread_relinquish();
+        }
+        // This is the only thread writing the strip buffers: timecoded DDP frames, frame deadlines and the
+        // startup/idle patterns are all presented from here
+        wait = std::min(DDPPacket::present(), Control::instance().updateStrips());
     }
 }
 
+static void artnet_receive_notify(NX_UDP_SOCKET *socket_ptr) { Network::instance().ArtNetReceive(socket_ptr); }
+
+void Network::ArtNetReceive(NX_UDP_SOCKET *socket_ptr) { ingestPush(socket_ptr, INGEST_ARTNET); }
+
 void Network::ArtNetSend(const NXD_ADDRESS *addr, uint16_t port, const uint8_t *data, size_t len) {
     NX_PACKET *packet_ptr = 0;
     UINT status = nx_packet_allocate(&client_pool, &packet_ptr, NX_UDP_PACKET, TX_WAIT_FOREVER);
@@ -253,20 +358,7 @@ void Network::ArtNetSend(const NXD_ADDRESS *addr, uint16_t port, const uint8_t *
 
 static void sacn_receive_notify(NX_UDP_SOCKET *socket_ptr) { Network::instance().sACNReceive(socket_ptr); }
 
-void Network::sACNReceive(NX_UDP_SOCKET *socket_ptr) {
-    NX_PACKET *packet_ptr = 0;
-    while (nx_udp_socket_receive(socket_ptr, &packet_ptr, NX_NO_WAIT) == NX_SUCCESS) {
-        NXD_ADDRESS recvAddr{};
-        UINT status = nxd_udp_packet_info_extract(packet_ptr, &recvAddr, NULL, NULL, NULL);
-        if (status != NX_SUCCESS) {
-            return;
-        }
-        const uint8_t *sacnBuf = packet_ptr->nx_packet_prepend_ptr;
-        size_t sacnLen = size_t(packet_ptr->nx_packet_append_ptr - packet_ptr->nx_packet_prepend_ptr);
-        sACNPacket::dispatch(&recvAddr, sacnBuf, sacnLen, AddrIsBroadcast(&recvAddr));
-        nx_packet_release(packet_ptr);
-    }
-}
+void Network::sACNReceive(NX_UDP_SOCKET *socket_ptr) { ingestPush(socket_ptr, INGEST_SACN); }
 
 void Network::sACNSend(const NXD_ADDRESS *addr, uint16_t port, const uint8_t *data, size_t len) {
     NX_PACKET *packet_ptr = 0;
@@ -286,20 +378,7 @@ void Network::sACNSend(const NXD_ADDRESS *addr, uint16_t port, const uint8_t *da
 
 static void ddp_receive_notify(NX_UDP_SOCKET *socket_ptr) { Network::instance().DDPReceive(socket_ptr); }
 
-void Network::DDPReceive(NX_UDP_SOCKET *socket_ptr) {
-    NX_PACKET *packet_ptr = 0;
-    while (nx_udp_socket_receive(socket_ptr, &packet_ptr, NX_NO_WAIT) == NX_SUCCESS) {
-        NXD_ADDRESS recvAddr{};
-        UINT status = nxd_udp_packet_info_extract(packet_ptr, &recvAddr, NULL, NULL, NULL);
-        if (status != NX_SUCCESS) {
-            return;
-        }
-        const uint8_t *ddpBuf = packet_ptr->nx_packet_prepend_ptr;
-        size_t ddpLen = size_t(packet_ptr->nx_packet_append_ptr - packet_ptr->nx_packet_prepend_ptr);
-        DDPPacket::dispatch(&recvAddr, ddpBuf, ddpLen, AddrIsBroadcast(&recvAddr));
-        nx_packet_release(packet_ptr);
-    }
-}
+void Network::DDPReceive(NX_UDP_SOCKET *socket_ptr) { ingestPush(socket_ptr, INGEST_DDP); }
 
 void Network::DDPSend(const NXD_ADDRESS *addr, uint16_t port, const uint8_t *data, size_t len) {
     NX_PACKET *packet_ptr = 0;
@@ -367,6 +446,7 @@ uint8_t *Network::setup(uint8_t *pointer) {
     const size_t mdns_service_cache_size = 2048;
     const size_t mdns_peer_service_cache_size = 2048;
     const size_t dhcpv6_client_stack_size = 2048;
+    const size_t ingest_stack_size = 4096;
 #endif  // #ifndef BOOTLOADER
     const size_t arp_cache_size = 2048;
 
@@ -376,6 +456,18 @@ uint8_t *Network::setup(uint8_t *pointer) {
     pointer = pointer + NX_PACKET_POOL_SIZE;
     if (status) goto fail;
 
+#ifndef BOOTLOADER
+    status = nx_packet_pool_low_watermark_set(&client_pool, NX_PACKET_POOL_RESERVE);
+    if (status) goto fail;
+
+    status = nx_packet_pool_create(&web_pool, const_cast<CHAR *>("NetX Web Packet Pool"), ETH_MAX_PACKET_SIZE, pointer, NX_WEB_PACKET_POOL_SIZE);
+    pointer = pointer + NX_WEB_PACKET_POOL_SIZE;
+    if (status) goto fail;
+
+    rx_pool_low = client_pool.nx_packet_pool_total;
+    web_pool_low = web_pool.nx_packet_pool_total;
+#endif  // #ifndef BOOTLOADER
+
     status = nx_ip_create(&client_ip, const_cast<CHAR *>(hostname), IP_ADDRESS(0, 0, 0, 0), 0xFFFFFF00UL, &client_pool, nx_stm32_eth_driver, pointer, ip_stack_size,
                           NX_IP_THREAD_PRIORITY);
     pointer = pointer + ip_stack_size;
@@ -409,29 +501,37 @@ uint8_t *Network::setup(uint8_t *pointer) {
     if (status) goto fail;
 
     status =
-        nx_mdns_create(&mdns, &client_ip, &client_pool, 3, pointer, mdns_stack_size, (UCHAR *)hostname, (VOID *)(pointer + mdns_service_cache_size),
+        nx_mdns_create(&mdns, &client_ip, &web_pool, 3, pointer, mdns_stack_size, (UCHAR *)hostname, (VOID *)(pointer + mdns_service_cache_size),
                        mdns_service_cache_size, (VOID *)(pointer + mdns_service_cache_size + mdns_peer_service_cache_size), mdns_peer_service_cache_size, NULL);
     pointer = pointer + mdns_stack_size + mdns_service_cache_size + mdns_peer_service_cache_size;
     if (status) goto fail;
 
-    status = nx_dhcpv6_client_create(&dhcpv6_client, &client_ip, const_cast<CHAR *>(hostname), &client_pool, pointer, dhcpv6_client_stack_size, dhcpv6_state_change,
+    status = nx_dhcpv6_client_create(&dhcpv6_client, &client_ip, const_cast<CHAR *>(hostname), &web_pool, pointer, dhcpv6_client_stack_size, dhcpv6_state_change,
                                      dhcpv6_server_error);
     pointer = pointer + dhcpv6_client_stack_size;
     if (status) goto fail;
 
-    status = nx_udp_socket_create(&client_ip, &artnet_socket, const_cast<CHAR *>("Art-Net"), NX_IP_MIN_DELAY, NX_DONT_FRAGMENT, NX_IP_TIME_TO_LIVE, 8);
+    status = tx_event_flags_create(&ingest_flags, const_cast<CHAR *>("ingest"));
+    if (status) goto fail;
+
+    status = tx_thread_create(&thread_ingest, const_cast<CHAR *>("ingest"), thread_ingest_entry, 0, pointer, ingest_stack_size, NX_INGEST_THREAD_PRIORITY,
+                              NX_INGEST_THREAD_PRIORITY, TX_NO_TIME_SLICE, TX_DONT_START);
+    pointer = pointer + ingest_stack_size;
+    if (status) goto fail;
+
+    status = nx_udp_socket_create(&client_ip, &artnet_socket, const_cast<CHAR *>("Art-Net"), NX_IP_MIN_DELAY, NX_DONT_FRAGMENT, NX_IP_TIME_TO_LIVE, ingestRingSize);
     if (status) goto fail;
 
     status = nx_udp_socket_receive_notify(&artnet_socket, artnet_receive_notify);
     if (status) goto fail;
 
-    status = nx_udp_socket_create(&client_ip, &sacn_socket, const_cast<CHAR *>("sACN"), NX_IP_MIN_DELAY, NX_DONT_FRAGMENT, NX_IP_TIME_TO_LIVE, 8);
+    status = nx_udp_socket_create(&client_ip, &sacn_socket, const_cast<CHAR *>("sACN"), NX_IP_MIN_DELAY, NX_DONT_FRAGMENT, NX_IP_TIME_TO_LIVE, ingestRingSize);
     if (status) goto fail;
 
     status = nx_udp_socket_receive_notify(&sacn_socket, sacn_receive_notify);
     if (status) goto fail;
 
-    status = nx_udp_socket_create(&client_ip, &ddp_socket, const_cast<CHAR *>("DDP"), NX_IP_MIN_DELAY, NX_DONT_FRAGMENT, NX_IP_TIME_TO_LIVE, 8);
+    status = nx_udp_socket_create(&client_ip, &ddp_socket, const_cast<CHAR *>("DDP"), NX_IP_MIN_DELAY, NX_DONT_FRAGMENT, NX_IP_TIME_TO_LIVE, ingestRingSize);
     if (status) goto fail;
 
     status = nx_udp_socket_receive_notify(&ddp_socket, ddp_receive_notify);
@@ -622,6 +722,11 @@ bool Network::start() {
             return false;
         }
 
+        status = tx_thread_resume(&thread_ingest);
+        if (status) {
+            return false;
+        }
+
         status = nx_udp_socket_bind(&artnet_socket, ArtNetPacket::port, NX_WAIT_FOREVER);
         if (status) {
             return false;
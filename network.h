@@ -26,6 +26,11 @@ SOFTWARE.
 
 #include <stdint.h>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+
+#include "./model.h"
 #include "nx_api.h"
 #include "nx_auto_ip.h"
 #include "nxd_dhcp_client.h"
@@ -35,13 +40,24 @@ SOFTWARE.
 
 class Network {
    public:
+    enum IngestProtocol : uint8_t { INGEST_ARTNET, INGEST_SACN, INGEST_DDP, INGEST_PROTOCOL_COUNT };
+
+    static constexpr size_t ingestRingSize = 64;
+    static constexpr size_t ingestMinDepth = 4;
+    // One and a half frames of every universe, or the whole ring if that is less; also bounds the packets the ring pins in total
+    static constexpr size_t ingestMaxDepth = std::min(Model::maxUniverses + Model::maxUniverses / 2, ingestRingSize);
+
     static Network &instance();
 
     uint8_t *setup(uint8_t *pointer);
     bool start();
 
     NX_IP *ip() { return &client_ip; };
+#ifndef BOOTLOADER
+    NX_PACKET_POOL *pool() { return &web_pool; }
+#else   // #ifndef BOOTLOADER
     NX_PACKET_POOL *pool() { return &client_pool; }
+#endif  // #ifndef BOOTLOADER
 
     const char *hostName() const { return hostname; }
     const uint8_t *MACAddr() const { return macaddr; }
@@ -60,6 +76,20 @@ class Network {
     bool AddrIsBroadcast(const NXD_ADDRESS *addrToCheck) const;
     bool AddrToString(const NXD_ADDRESS *value, char *ip_str, size_t max_len) const;
 
+#ifndef BOOTLOADER
+    void ingest();
+    void scheduleReconfigure() { tx_event_flags_set(&ingest_flags, ingestReconfigure, TX_OR); }
+    void scheduleTimeouts() { tx_event_flags_set(&ingest_flags, ingestTimeouts, TX_OR); }
+    void scheduleColor() { tx_event_flags_set(&ingest_flags, ingestColor, TX_OR); }
+    void setIngestDepth(IngestProtocol protocol, size_t universes);
+    size_t ingestDepth(IngestProtocol protocol) const { return ingest_depth[protocol]; }
+    uint32_t ingestDrops(IngestProtocol protocol) const { return ingest_drops[protocol]; }
+    size_t ingestHighWater() const { return ingest_high_water; }
+    void samplePools();
+    size_t rxPoolHighWater() const { return size_t(client_pool.nx_packet_pool_total - rx_pool_low); }
+    size_t webPoolHighWater() const { return size_t(web_pool.nx_packet_pool_total - web_pool_low); }
+#endif  // #ifndef BOOTLOADER
+
    private:
     void init();
     bool initialized = false;
@@ -69,6 +99,9 @@ class Network {
     NX_DHCP dhcp_client{};
     NX_DHCPV6 dhcpv6_client{};
     NX_PACKET_POOL client_pool{};
+#ifndef BOOTLOADER
+    NX_PACKET_POOL web_pool{};
+#endif  // #ifndef BOOTLOADER
     NX_MDNS mdns{};
     NXD_ADDRESS ipv4{};
     NXD_ADDRESS ipv4mask{};
@@ -78,6 +111,37 @@ class Network {
     NX_UDP_SOCKET sacn_socket{};
     NX_UDP_SOCKET ddp_socket{};
 
+#ifndef BOOTLOADER
+    struct IngestEntry {
+        NX_PACKET *packet;
+        IngestProtocol protocol;
+    };
+
+    // Receive notifies run in the IP thread, so they only queue packets; the ingest thread parses them.
+    static constexpr size_t ingestBatchSize = 8;
+    static constexpr ULONG ingestPending = 0x1;
+    static constexpr ULONG ingestReconfigure = 0x2;
+    static constexpr ULONG ingestTimeouts = 0x4;
+    static constexpr ULONG ingestColor = 0x8;
+    static_assert((ingestRingSize & (ingestRingSize - 1)) == 0);
+
+    void ingestPush(NX_UDP_SOCKET *socket_ptr, IngestProtocol protocol);
+    size_t ingestDrain();
+    void ingestDispatch(const IngestEntry &entry);
+
+    std::array<IngestEntry, ingestRingSize> ingest_ring{};
+    std::atomic<uint32_t> ingest_head{0};
+    std::atomic<uint32_t> ingest_tail{0};
+    std::array<std::atomic<uint16_t>, INGEST_PROTOCOL_COUNT> ingest_inflight{};
+    std::array<uint16_t, INGEST_PROTOCOL_COUNT> ingest_depth{ingestMaxDepth, ingestMaxDepth, ingestMaxDepth};
+    std::array<uint32_t, INGEST_PROTOCOL_COUNT> ingest_drops{};
+    size_t ingest_high_water = 0;
+    ULONG rx_pool_low = 0;
+    ULONG web_pool_low = 0;
+    TX_EVENT_FLAGS_GROUP ingest_flags{};
+    TX_THREAD thread_ingest{};
+#endif  // #ifndef BOOTLOADER
+
     uint32_t murmur3_32(const uint8_t *key, size_t len, uint32_t seed) const;
 
 #ifndef BOOTLOADER
@@ -29,25 +29,51 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "./artnet.h"
 #include "./control.h"
+#include "./merge.h"
+#include "./model.h"
 #include "./network.h"
+#include "./sequence.h"
+#include "./systick.h"
 
 #ifndef BOOTLOADER
 
+// E1.31 network data loss timeout
+static SequenceTracker sequenceTracker(2500);
+
 class DataPacket : public sACNPacket {
    public:
     DataPacket(){};
     virtual ~DataPacket(){};
 
+    static constexpr uint8_t optionPreview = 0x80;
+    static constexpr uint8_t optionTerminated = 0x40;
+    static constexpr uint8_t startcodeLevels = 0x00;
+    static constexpr uint8_t startcodePriority = 0xDD;
+
+    uint8_t priority() const { return packet[108]; };
+    uint8_t options() const { return packet[112]; };
+    uint8_t startcode() const { return packet[125]; };
     uint16_t syncuniverse() const { return (packet[109] << 8) | (packet[110] << 0); };
+    uint8_t sequence() const { return packet[111]; };
     uint16_t universe() const { return (packet[113] << 8) | (packet[114] << 0); };
     size_t datalen() const { return (packet[123] << 8) | (packet[124] << 0); };
     const uint8_t *data() const { return &packet[125]; }
+    uint32_t source() const {
+        uint32_t hash = 0x811C9DC5;
+        for (size_t c = 22; c < 38; c++) {
+            hash = (hash ^ packet[c]) * 0x01000193;
+        }
+        return hash;
+    }
 
    private:
     virtual bool verify() const override {
         if (datalen() > 513 || datalen() < 1) {
             return false;
         }
+        if (packet.size() < 125 + datalen()) {
+            return false;
+        }
         if (packet[118] != 0xa1) {
             return false;
         }
@@ -61,6 +87,215 @@ class DataPacket : public sACNPacket {
     }
 };
 
+// Keeps the live sources of every universe and decides what reaches the outputs. Only sources tied at the winning
+// priority, or sources sending per-address priorities, are merged; otherwise the winning packet goes straight through.
+class SourceMerge {
+   public:
+    const uint8_t *arbitrate(const DataPacket &packet, size_t &len);
+
+   private:
+    static constexpr size_t sourceN = 32;
+    static constexpr size_t slotN = 512;
+    static constexpr uint32_t lossTimeoutMs = 2500;
+    static constexpr uint8_t maxPriority = 200;
+
+    struct Source {
+        uint64_t seen;
+        uint64_t priority_seen;
+        uint32_t cid;
+        uint16_t universe;
+        uint16_t len;
+        uint8_t priority;
+        uint8_t expanded_priority;
+        bool used;
+        bool stored;
+        bool per_address;
+        bool expanded;
+        alignas(4) std::array<uint8_t, slotN> levels;
+        alignas(4) std::array<uint8_t, slotN> priorities;
+    };
+
+    void store(Source &source, const uint8_t *data, size_t len);
+    void settle(Source &source, size_t len);
+    const uint8_t *expand(Source &source);
+
+    std::array<Source, sourceN> sources{};
+    alignas(4) std::array<uint8_t, slotN> merged{};
+    alignas(4) std::array<uint8_t, slotN> merged_priorities{};
+};
+
+static SourceMerge sourceMerge;
+
+void SourceMerge::store(Source &source, const uint8_t *data, size_t len) {
+    memcpy(source.levels.data(), data, len);
+    settle(source, len);
+}
+
+// Levels past the end of a frame read as zero
+void SourceMerge::settle(Source &source, size_t len) {
+    if (len < source.len) {
+        memset(source.levels.data() + len, 0, source.len - len);
+    }
+    source.len = uint16_t(len);
+    source.stored = true;
+}
+
+const uint8_t *SourceMerge::expand(Source &source) {
+    if (!source.per_address && (!source.expanded || source.expanded_priority != source.priority)) {
+        memset(source.priorities.data(), source.priority, slotN);
+        source.expanded_priority = source.priority;
+        source.expanded = true;
+    }
+    return source.priorities.data();
+}
+
+const uint8_t *SourceMerge::arbitrate(const DataPacket &packet, size_t &len) {
+    const uint64_t now = Systick::instance().systemTimeRAW();
+    const uint64_t timeout = Systick::msToCycles(lossTimeoutMs);
+    const uint16_t universe = packet.universe();
+    const uint32_t cid = packet.source();
+    const uint8_t *data = packet.data() + 1;
+    len = std::min(packet.datalen() - 1, slotN);
+
+    Source *self = nullptr;
+    Source *unused = nullptr;
+    std::array<Source *, sourceN> others{};
+    size_t other_count = 0;
+    for (Source &source : sources) {
+        if (source.used && Systick::elapsed(now, source.seen, timeout)) {
+            source.used = false;
+        }
+        if (!source.used) {
+            if (!unused) {
+                unused = &source;
+            }
+            continue;
+        }
+        if (source.universe != universe) {
+            continue;
+        }
+        if (source.per_address && Systick::elapsed(now, source.priority_seen, timeout)) {
+            source.per_address = false;
+            source.expanded = false;
+        }
+        if (source.cid == cid) {
+            self = &source;
+        } else {
+            others[other_count++] = &source;
+        }
+    }
+
+    if (packet.options() & (DataPacket::optionPreview | DataPacket::optionTerminated)) {
+        if (self && (packet.options() & DataPacket::optionTerminated)) {
+            self->used = false;
+        }
+        return nullptr;
+    }
+
+    if (!self) {
+        if (!unused) {
+            // Out of source slots, stick with whoever already drives this universe
+            return other_count ? nullptr : data;
+        }
+        self = unused;
+        self->cid = cid;
+        self->universe = universe;
+        self->len = slotN;
+        self->used = true;
+        self->stored = false;
+        self->per_address = false;
+        self->expanded = false;
+    }
+    self->seen = now;
+    self->priority = std::min(packet.priority(), maxPriority);
+
+    switch (packet.startcode()) {
+        case DataPacket::startcodeLevels: {
+        } break;
+        case DataPacket::startcodePriority: {
+            memcpy(self->priorities.data(), data, len);
+            memset(self->priorities.data() + len, 0, slotN - len);
+            self->priority_seen = now;
+            self->per_address = true;
+            self->expanded = false;
+            return nullptr;
+        } break;
+        default: {
+            return nullptr;
+        } break;
+    }
+
+    if (other_count == 0) {
+        self->stored = false;
+        if (self->per_address) {
+            Merge::release(merged.data(), data, self->priorities.data(), len);
+            return merged.data();
+        }
+        return data;
+    }
+
+    const bool htp = !Model::instance().mergeLTP;
+    bool per_address = self->per_address;
+    uint8_t top = self->priority;
+    for (size_t c = 0; c < other_count; c++) {
+        per_address |= others[c]->per_address;
+        top = std::max(top, others[c]->priority);
+    }
+
+    if (!per_address) {
+        if (self->priority < top) {
+            store(*self, data, len);
+            return nullptr;
+        }
+        size_t tied = 0;
+        for (size_t c = 0; c < other_count; c++) {
+            if (others[c]->priority == top) {
+                others[tied++] = others[c];
+            }
+        }
+        // A sole winner, or LTP between equals, is the packet itself
+        if (tied == 0 || !htp) {
+            self->stored = false;
+            return data;
+        }
+        other_count = tied;
+    }
+
+    // Until every contender has a frame on file the output stays where it is
+    const size_t own = len;
+    for (size_t c = 0; c < other_count; c++) {
+        if (!others[c]->stored) {
+            store(*self, data, own);
+            return nullptr;
+        }
+        len = std::max(len, size_t(others[c]->len));
+    }
+
+    if (!per_address) {
+        // Files this frame while folding it against the first contender
+        Merge::htp(merged.data(), self->levels.data(), data, others[0]->levels.data(), own);
+        settle(*self, own);
+        if (len > own) {
+            memcpy(merged.data() + own, others[0]->levels.data() + own, len - own);
+        }
+        for (size_t c = 1; c < other_count; c++) {
+            Merge::htp(merged.data(), merged.data(), others[c]->levels.data(), len);
+        }
+        return merged.data();
+    }
+
+    // Latest source first so LTP ties go to the most recent frame
+    std::sort(others.begin(), others.begin() + other_count, [](const Source *a, const Source *b) { return a->seen > b->seen; });
+    store(*self, data, own);
+    memcpy(merged.data(), self->levels.data(), len);
+    memcpy(merged_priorities.data(), expand(*self), len);
+    for (size_t c = 0; c < other_count; c++) {
+        Merge::prioritized(merged.data(), merged_priorities.data(), others[c]->levels.data(), expand(*others[c]), len, htp);
+    }
+    Merge::release(merged.data(), merged.data(), merged_priorities.data(), len);
+    return merged.data();
+}
+
 class SyncPacket : public sACNPacket {
    public:
     SyncPacket(){};
@@ -82,7 +317,7 @@ class DiscoveryPacket : public sACNPacket {
 };
 
 sACNPacket::PacketType sACNPacket::maybeValid(const uint8_t *buf, size_t len) {
-    if (len > sizeof(packet)) {
+    if (len > maxPacketSize) {
         return PacketInvalid;
     }
 
@@ -160,7 +395,7 @@ bool sACNPacket::verify(sACNPacket &packet, const uint8_t *buf, size_t len) {  /
     if (type == PacketInvalid) {
         return false;
     }
-    memcpy(packet.packet.data(), buf, std::min(len, packet.packet.size()));
+    packet.packet = std::span<const uint8_t>(buf, len);
     switch (type) {
         case PacketData:
         case PacketSync:
@@ -194,11 +429,9 @@ void sACNPacket::sendDiscovery() {
         uint16_t universes[Model::maxUniverses];
     } __attribute__((packed)) discovery;
 
-    size_t universeCount = 0;
-    std::array<uint16_t, Model::maxUniverses> universes;
-    Control::instance().collectAllActiveE131Universes(universes, universeCount);
-    std::sort(universes.begin(), universes.begin() + universeCount);
-    size_t replySize = offsetof(sACNDiscovery, universes) + universeCount * sizeof(uint16_t);
+    std::array<uint16_t, Model::maxUniverses> active{};
+    const std::span<const uint16_t> universes(active.data(), Control::instance().activeE131Universes(active));
+    size_t replySize = offsetof(sACNDiscovery, universes) + universes.size() * sizeof(uint16_t);
 
     auto hton16 = [](uint16_t v) { return uint16_t((v >> 8) | (v << 8)); };
     auto hton32 = [](uint32_t v) { return uint32_t(((v >> 24) & 0x000000FF) | ((v >> 8) & 0x0000FF00) | ((v << 24) & 0xFF000000) | ((v << 8) & 0x00FF0000)); };
@@ -218,7 +451,7 @@ void sACNPacket::sendDiscovery() {
     discovery.vectorDiscovery = hton32(VECTOR_UNIVERSE_DISCOVERY_UNIVERSE_LIST);
     discovery.page = 0;
     discovery.last = 0;
-    for (size_t c = 0; c < universeCount; c++) {
+    for (size_t c = 0; c < universes.size(); c++) {
         discovery.universes[c] = hton16(universes[c]);
     }
 
@@ -241,9 +474,17 @@ bool sACNPacket::dispatch(const NXD_ADDRESS *from, const uint8_t *buf, size_t le
             }
             DataPacket dataPacket;
             if (sACNPacket::verify(dataPacket, buf, len)) {
-                Control::instance().setE131UniverseOutputData(dataPacket.universe(), dataPacket.data() + 1, dataPacket.datalen() - 1);
+                if (sequenceTracker.check(dataPacket.universe(), dataPacket.source(), dataPacket.sequence()) != SequenceTracker::Accept) {
+                    return false;
+                }
+                size_t datalen = 0;
+                const uint8_t *data = sourceMerge.arbitrate(dataPacket, datalen);
+                if (!data) {
+                    return true;
+                }
+                Control::instance().setE131UniverseOutputData(dataPacket.universe(), data, datalen, dataPacket.sequence());
                 syncuniverse = dataPacket.syncuniverse();
-                if (dataPacket.syncuniverse() == 0) {
+                if (dataPacket.syncuniverse() == 0 && Control::instance().syncModeEnabled()) {
                     Control::instance().sync();
                     Control::instance().setEnableSyncMode(false);
                 }
@@ -277,22 +518,52 @@ bool sACNPacket::dispatch(const NXD_ADDRESS *from, const uint8_t *buf, size_t le
     return false;
 }
 
+// Multicast groups currently joined, kept sorted like the active set so a config change only touches the difference
+static std::array<uint16_t, Model::maxUniverses> joinedUniverses{};
+static size_t joinedCount = 0;
+
+void sACNPacket::sequenceStats(SequenceTracker::UniverseStats &out) { sequenceTracker.copyStats(out); }
+
 void sACNPacket::leaveNetworks() {
-    size_t universeCount = 0;
-    std::array<uint16_t, Model::maxUniverses> universes;
-    Control::instance().collectAllActiveE131Universes(universes, universeCount);
-    for (size_t c = 0; c < universeCount; c++) {
-        nx_igmp_multicast_interface_leave(Network::instance().ip(), 0xEFFF0000 | universes[c], 0);
+    for (size_t c = 0; c < joinedCount; c++) {
+        nx_igmp_multicast_interface_leave(Network::instance().ip(), 0xEFFF0000 | joinedUniverses[c], 0);
     }
+    joinedCount = 0;
 }
 
-void sACNPacket::joinNetworks() {
-    size_t universeCount = 0;
-    std::array<uint16_t, Model::maxUniverses> universes;
-    Control::instance().collectAllActiveE131Universes(universes, universeCount);
-    for (size_t c = 0; c < universeCount; c++) {
-        nx_igmp_multicast_interface_join(Network::instance().ip(), 0xEFFF0000 | universes[c], 0);
+void sACNPacket::updateNetworks() {
+    std::array<uint16_t, Model::maxUniverses> universes{};
+    const std::span<const uint16_t> active(universes.data(), Control::instance().activeE131Universes(universes));
+
+    // Leave first so the IGMP group table has room for the joins
+    size_t kept = 0;
+    for (size_t c = 0, a = 0; c < joinedCount; c++) {
+        while (a < active.size() && active[a] < joinedUniverses[c]) {
+            a++;
+        }
+        if (a < active.size() && active[a] == joinedUniverses[c]) {
+            joinedUniverses[kept++] = joinedUniverses[c];
+        } else {
+            nx_igmp_multicast_interface_leave(Network::instance().ip(), 0xEFFF0000 | joinedUniverses[c], 0);
+        }
     }
+
+    std::array<uint16_t, Model::maxUniverses> joined{};
+    size_t count = 0;
+    for (size_t a = 0, c = 0; a < active.size(); a++) {
+        while (c < kept && joinedUniverses[c] < active[a]) {
+            joined[count++] = joinedUniverses[c++];
+        }
+        if (c < kept && joinedUniverses[c] == active[a]) {
+            joined[count++] = joinedUniverses[c++];
+        } else if (nx_igmp_multicast_interface_join(Network::instance().ip(), 0xEFFF0000 | active[a], 0) == NX_SUCCESS) {
+            joined[count++] = active[a];
+        }
+    }
+    joinedUniverses = joined;
+    joinedCount = count;
+
+    sequenceTracker.setUniverses(active);
 }
 
 uint16_t sACNPacket::syncuniverse = 0;
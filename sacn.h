@@ -26,7 +26,9 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <stdint.h>
 
 #include <array>
+#include <span>
 
+#include "./sequence.h"
 #include "nx_api.h"
 
 class sACNPacket {
@@ -48,15 +50,20 @@ class sACNPacket {
 
     static bool dispatch(const NXD_ADDRESS *from, const uint8_t *buf, size_t len, bool isBroadcast);
     static void sendDiscovery();
-    static void joinNetworks();
+    static void updateNetworks();
     static void leaveNetworks();
+#ifndef BOOTLOADER
+    static void sequenceStats(SequenceTracker::UniverseStats &out);
+#endif  // #ifndef BOOTLOADER
 
    protected:
     sACNPacket(){};
     virtual ~sACNPacket(){};
 
+    static constexpr size_t maxPacketSize = 1143;
+
     virtual bool verify() const { return false; }
-    std::array<uint8_t, 1143> packet{};
+    std::span<const uint8_t> packet{};
     static uint16_t syncuniverse;
 
    private:
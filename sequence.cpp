@@ -0,0 +1,127 @@
+/*
+Copyright 2023 Tinic Uro
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "./sequence.h"
+
+#include <algorithm>
+
+#include "./systick.h"
+
+#ifndef BOOTLOADER
+
+SequenceTracker::Result SequenceTracker::check(uint16_t universe, uint32_t source, uint8_t sequence) {
+    const uint64_t now = Systick::instance().systemTimeRAW();
+    const uint64_t timeout = Systick::msToCycles(timeout_ms);
+
+    Entry *slot = nullptr;
+    for (size_t c = 0, h = (universe * 0x9E3779B1U) ^ source; c < entryN; c++, h++) {
+        Entry &entry = entries[h & (entryN - 1)];
+        if (!entry.used) {
+            if (!slot) {
+                slot = &entry;
+            }
+            break;
+        }
+        if (entry.universe == universe && entry.source == source) {
+            if (Systick::elapsed(now, entry.seen, timeout)) {
+                // Source was lost, whatever it sends now starts a new stream
+                slot = &entry;
+                break;
+            }
+            entry.seen = now;
+            const int32_t diff = int8_t(uint8_t(sequence - entry.sequence));
+            if (diff == 0) {
+                if (Stats *stats = universeStats(universe)) {
+                    stats->duplicates++;
+                }
+                return Duplicate;
+            }
+            if (diff < 0 && diff > -rejectWindow) {
+                if (Stats *stats = universeStats(universe)) {
+                    stats->reorders++;
+                }
+                return Reordered;
+            }
+            if (diff > 1) {
+                if (Stats *stats = universeStats(universe)) {
+                    stats->gaps += uint32_t(diff - 1);
+                }
+            }
+            entry.sequence = sequence;
+            return Accept;
+        }
+        if (!slot && Systick::elapsed(now, entry.seen, timeout)) {
+            slot = &entry;
+        }
+    }
+
+    if (slot) {
+        *slot = {now, source, universe, sequence, true};
+    }
+    return Accept;
+}
+
+SequenceTracker::Stats *SequenceTracker::universeStats(uint16_t universe) {
+    // Only reached for packets that are out of order, so a binary search is cheap enough
+    const auto end = universes.begin() + universe_count;
+    const auto it = std::lower_bound(universes.begin(), end, universe);
+    if (it == end || *it != universe) {
+        return nullptr;
+    }
+    return &counters[size_t(it - universes.begin())];
+}
+
+void SequenceTracker::setUniverses(std::span<const uint16_t> active) {
+    std::array<Stats, Model::maxUniverses> kept{};
+    const size_t count = std::min(active.size(), kept.size());
+    for (size_t c = 0, o = 0; c < count; c++) {
+        while (o < universe_count && universes[o] < active[c]) {
+            o++;
+        }
+        if (o < universe_count && universes[o] == active[c]) {
+            kept[c] = counters[o];
+        }
+    }
+
+    generation.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::copy_n(active.begin(), count, universes.begin());
+    counters = kept;
+    universe_count = count;
+    generation.fetch_add(1, std::memory_order_release);
+}
+
+void SequenceTracker::copyStats(UniverseStats &out) const {
+    for (;;) {
+        const uint32_t before = generation.load(std::memory_order_acquire);
+        out.count = universe_count;
+        std::copy_n(universes.begin(), out.count, out.universes.begin());
+        std::copy_n(counters.begin(), out.count, out.stats.begin());
+        std::atomic_thread_fence(std::memory_order_acquire);
+        // A reader never runs in the middle of setUniverses(), but retry anyway if the table changed under the copy
+        if ((before & 1) == 0 && generation.load(std::memory_order_relaxed) == before) {
+            return;
+        }
+    }
+}
+
+#endif  // #ifndef BOOTLOADER
@@ -0,0 +1,91 @@
+/*
+Copyright 2023 Tinic Uro
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#ifndef _SEQUENCE_H_
+#define _SEQUENCE_H_
+
+#include <stdint.h>
+
+#include <array>
+#include <atomic>
+#include <span>
+
+#include "./model.h"
+
+#ifndef BOOTLOADER
+
+// Tracks the sequence byte per universe and source and rejects duplicates and late packets using the
+// E1.31 window: anything 0 to 19 behind the last accepted value is dropped.
+class SequenceTracker {
+   public:
+    enum Result { Accept, Duplicate, Reordered };
+
+    struct Stats {
+        uint32_t gaps;
+        uint32_t reorders;
+        uint32_t duplicates;
+    };
+
+    // Counters of the routed universes, summed over their sources
+    struct UniverseStats {
+        std::array<uint16_t, Model::maxUniverses> universes;
+        std::array<Stats, Model::maxUniverses> stats;
+        size_t count;
+    };
+
+    explicit SequenceTracker(uint32_t timeout) : timeout_ms(timeout) {}
+
+    Result check(uint16_t universe, uint32_t source, uint8_t sequence);
+
+    // Takes the sorted active set of the routing table. Universes that stay routed keep their counters,
+    // packets for unrouted universes are still checked but not counted. Call from the thread calling check().
+    void setUniverses(std::span<const uint16_t> active);
+    // Safe from any thread running at a lower priority than the one calling check()
+    void copyStats(UniverseStats &out) const;
+
+   private:
+    static constexpr size_t entryN = 128;
+    static constexpr int32_t rejectWindow = 20;
+    static_assert(entryN >= Model::maxUniverses * 2 && (entryN & (entryN - 1)) == 0);
+
+    struct Entry {
+        uint64_t seen;
+        uint32_t source;
+        uint16_t universe;
+        uint8_t sequence;
+        bool used;
+    };
+
+    Stats *universeStats(uint16_t universe);
+
+    uint32_t timeout_ms;
+    std::array<Entry, entryN> entries{};
+    // Odd while setUniverses() rewrites the table below
+    std::atomic<uint32_t> generation{0};
+    std::array<uint16_t, Model::maxUniverses> universes{};
+    std::array<Stats, Model::maxUniverses> counters{};
+    size_t universe_count = 0;
+};
+
+#endif  // #ifndef BOOTLOADER
+
+#endif  // #ifndef _SEQUENCE_H_
@@ -33,7 +33,11 @@ SOFTWARE.
 #include <fixed_containers/fixed_string.hpp>
 #include <fixed_containers/fixed_vector.hpp>
 
+#include "./artnet.h"
 #include "./model.h"
+#include "./network.h"
+#include "./sacn.h"
+#include "./strip.h"
 #include "./support/ipv6.h"
 #include "./utils.h"
 #include "./webserver.h"
@@ -98,6 +102,80 @@ class packet_buffer final : public buffer {
 };
 }  // namespace emio
 
+#ifndef BOOTLOADER
+// Live counters appended to the settings JSON and never stored. Sampled once so that the counting pass and the
+// writing pass produce the same length.
+struct LiveStats {
+    static constexpr std::array<uint32_t (Strip::*)() const, 6> stripCounters{&Strip::framesComplete,     &Strip::framesTimedOut, &Strip::unchangedUniverses,
+                                                                             &Strip::overwrittenFrames, &Strip::lateFrames,     &Strip::earlyFrames};
+    static constexpr std::array<const char *, 6> stripNames{"strip_frames_complete",    "strip_frames_timed_out", "strip_unchanged_universes",
+                                                            "strip_overwritten_frames", "strip_late_frames",      "strip_early_frames"};
+    static constexpr std::array<uint32_t SequenceTracker::Stats::*, 3> sequenceCounters{&SequenceTracker::Stats::gaps, &SequenceTracker::Stats::reorders,
+                                                                                        &SequenceTracker::Stats::duplicates};
+    static constexpr std::array<const char *, 3> sequenceNames{"gaps", "reorders", "duplicates"};
+
+    std::array<uint32_t, Network::INGEST_PROTOCOL_COUNT> ingest_drops{};
+    size_t ingest_high_water = 0;
+    size_t rx_pool_high_water = 0;
+    size_t web_pool_high_water = 0;
+    SequenceTracker::UniverseStats artnet_sequence{};
+    SequenceTracker::UniverseStats e131_sequence{};
+    std::array<std::array<uint32_t, Model::stripN>, stripCounters.size()> strips{};
+
+    void sample() {
+        const Network &network = Network::instance();
+        for (size_t c = 0; c < ingest_drops.size(); c++) {
+            ingest_drops[c] = network.ingestDrops(Network::IngestProtocol(c));
+        }
+        ingest_high_water = network.ingestHighWater();
+        rx_pool_high_water = network.rxPoolHighWater();
+        web_pool_high_water = network.webPoolHighWater();
+        ArtNetPacket::sequenceStats(artnet_sequence);
+        sACNPacket::sequenceStats(e131_sequence);
+        for (size_t c = 0; c < stripCounters.size(); c++) {
+            for (size_t d = 0; d < Model::stripN; d++) {
+                strips[c][d] = (Strip::get(d).*stripCounters[c])();
+            }
+        }
+    }
+
+    void format(emio::buffer &buf) const {
+        // One array per counter, indexed like "universes"
+        auto sequence = [&buf](const char *name, const SequenceTracker::UniverseStats &stats) {
+            emio::format_to(buf, ",\"{}\":{{\"universes\":[", name).value();
+            for (size_t d = 0; d < stats.count; d++) {
+                emio::format_to(buf, "{}{}", d ? "," : "", stats.universes[d]).value();
+            }
+            emio::format_to(buf, "]").value();
+            for (size_t c = 0; c < sequenceCounters.size(); c++) {
+                emio::format_to(buf, ",\"{}\":[", sequenceNames[c]).value();
+                for (size_t d = 0; d < stats.count; d++) {
+                    emio::format_to(buf, "{}{}", d ? "," : "", stats.stats[d].*sequenceCounters[c]).value();
+                }
+                emio::format_to(buf, "]").value();
+            }
+            emio::format_to(buf, "}}").value();
+        };
+        emio::format_to(buf, "{{\"ingest_drops\":[{},{},{}]", ingest_drops[Network::INGEST_ARTNET], ingest_drops[Network::INGEST_SACN],
+                        ingest_drops[Network::INGEST_DDP])
+            .value();
+        emio::format_to(buf, ",\"ingest_high_water\":{},\"rx_pool_high_water\":{},\"web_pool_high_water\":{}", ingest_high_water, rx_pool_high_water,
+                        web_pool_high_water)
+            .value();
+        sequence("artnet_sequence", artnet_sequence);
+        sequence("e131_sequence", e131_sequence);
+        for (size_t c = 0; c < strips.size(); c++) {
+            emio::format_to(buf, ",\"{}\":[", stripNames[c]).value();
+            for (size_t d = 0; d < Model::stripN; d++) {
+                emio::format_to(buf, "{}{}", d ? "," : "", strips[c][d]).value();
+            }
+            emio::format_to(buf, "]").value();
+        }
+        emio::format_to(buf, "}}").value();
+    }
+};
+#endif  // #ifndef BOOTLOADER
+
 SettingsDB &SettingsDB::instance() {
     static SettingsDB settingsDB;
     if (!settingsDB.initialized) {
@@ -154,7 +232,12 @@ void SettingsDB::unlock() { __enable_irq(); }
 UINT SettingsDB::jsonGETRequest(NX_PACKET *packet_ptr) {
     nx_packet_release(packet_ptr);
 
-    auto toBuffer = [this](emio::buffer &buf) {
+#ifndef BOOTLOADER
+    LiveStats stats{};
+    stats.sample();
+#endif  // #ifndef BOOTLOADER
+
+    auto toBuffer = [&, this](emio::buffer &buf) {
         emio::format_to(buf, "{{").value();
         struct fdb_kv_iterator iterator {};
         fdb_kv_iterator_init(&kvdb, &iterator);
@@ -265,6 +348,10 @@ UINT SettingsDB::jsonGETRequest(NX_PACKET *packet_ptr) {
                 }
             }
         }
+#ifndef BOOTLOADER
+        emio::format_to(buf, "{}\"stats\":", comma).value();
+        stats.format(buf);
+#endif  // #ifndef BOOTLOADER
         emio::format_to(buf, "}}").value();
     };
 
@@ -498,6 +585,7 @@ UINT SettingsDB::jsonPUTRequest(NX_PACKET *packet_ptr, bool deleteRequest) {
     } while (!done);
     nx_packet_release(packet_ptr);
     if (Model::instance().importFromDB()) {
+        Network::instance().scheduleReconfigure();
         nx_http_server_callback_response_send_extended(WebServer::instance().httpServer(), const_cast<CHAR *>(NX_HTTP_STATUS_OK), sizeof(NX_HTTP_STATUS_OK) - 1, NX_NULL, 0,
                                                        NX_NULL, 0);
     } else {
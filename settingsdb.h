@@ -160,13 +160,16 @@ class SettingsDB {
     KEY_DEFINE_NUMBER(kMaxUniverses, "max_universes")
     KEY_DEFINE_NUMBER(kMaxStrips, "max_strips")
     KEY_DEFINE_NUMBER(kMaxAnalog, "max_analog")
+    KEY_DEFINE_NUMBER(kFrameDeadline, "frame_deadline_ms")
+    KEY_DEFINE_NUMBER(kDDPPlayoutDelay, "ddp_playout_delay_ms")
+    KEY_DEFINE_NUMBER(kStartupFps, "startup_fps")
 
 #define KEY_DEFINE_BOOL(KEY_CONSTANT, KEY_STRING)           \
     static constexpr const char *KEY_CONSTANT = KEY_STRING; \
     static constexpr const char *KEY_CONSTANT##_t = KEY_STRING KEY_TYPE_BOOL;
 
     KEY_DEFINE_BOOL(kBroadcastEnabled, "broadcast_enabled")
-    KEY_DEFINE_BOOL(kBurstModeEnabled, "burst_mode_enabled")
+    KEY_DEFINE_BOOL(kMergeLTP, "merge_ltp")
 
 #define KEY_DEFINE_STRING_VECTOR(KEY_CONSTANT, KEY_STRING)  \
     static constexpr const char *KEY_CONSTANT = KEY_STRING; \
@@ -201,7 +204,9 @@ class SettingsDB {
     KEY_DEFINE_NUMBER_VECTOR(kStripCompLimit, "strip_comp_limit")
     KEY_DEFINE_NUMBER_VECTOR(kStripGlobIllum, "strip_glob_illum")
     KEY_DEFINE_NUMBER_VECTOR(kStripLedCount, "strip_led_count")
+    KEY_DEFINE_NUMBER_VECTOR(kStripNrzBits, "strip_nrz_bits")
     KEY_DEFINE_NUMBER_VECTOR(kAnalogPwmLimit, "analog_pwm_limit")
+    KEY_DEFINE_NUMBER_VECTOR(kDDPStripOrder, "ddp_strip_order")
 
 #define KEY_DEFINE_NUMBER_VECTOR_2D(KEY_CONSTANT, KEY_STRING) \
     static constexpr const char *KEY_CONSTANT = KEY_STRING;   \
@@ -32,6 +32,10 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 static DMA_HandleTypeDef handle_GPDMA1_Channel7{};
 static DMA_HandleTypeDef handle_GPDMA2_Channel7{};
+static DMA_NodeTypeDef node_GPDMA1_Channel7{};
+static DMA_NodeTypeDef node_GPDMA2_Channel7{};
+static DMA_QListTypeDef queue_GPDMA1_Channel7{};
+static DMA_QListTypeDef queue_GPDMA2_Channel7{};
 static SPI_HandleTypeDef hspi1{};
 static SPI_HandleTypeDef hspi2{};
 
@@ -83,22 +87,50 @@ static void configSPI2Clock(uint32_t mul = 30, uint32_t div = 30) {
 void HAL_SPI_MspInit(SPI_HandleTypeDef *hspi) {  // cppcheck-suppress constParameterPointer
     GPIO_InitTypeDef GPIO_InitStruct{};
 
-    auto dmaInit = [hspi](DMA_HandleTypeDef &handle, DMA_Channel_TypeDef *instance, uint32_t request) {
+    // Circular linked list with a single node: the strip streams its frame through a small buffer and refills
+    // each half from the half/full transfer interrupts. HAL_SPI_Transmit_DMA fills in node addresses and size.
+    auto dmaInit = [hspi](DMA_HandleTypeDef &handle, DMA_NodeTypeDef &node, DMA_QListTypeDef &queue, DMA_Channel_TypeDef *instance, uint32_t request) {
+        DMA_NodeConfTypeDef nodeConfig{};
+        nodeConfig.NodeType = DMA_GPDMA_LINEAR_NODE;
+        nodeConfig.Init.Request = request;
+        nodeConfig.Init.BlkHWRequest = DMA_BREQ_SINGLE_BURST;
+        nodeConfig.Init.Direction = DMA_MEMORY_TO_PERIPH;
+        nodeConfig.Init.SrcInc = DMA_SINC_INCREMENTED;
+        nodeConfig.Init.DestInc = DMA_DINC_FIXED;
+        nodeConfig.Init.SrcDataWidth = DMA_SRC_DATAWIDTH_BYTE;
+        nodeConfig.Init.DestDataWidth = DMA_DEST_DATAWIDTH_BYTE;
+        nodeConfig.Init.SrcBurstLength = 1;
+        nodeConfig.Init.DestBurstLength = 1;
+        nodeConfig.Init.TransferAllocatedPort = DMA_SRC_ALLOCATED_PORT0 | DMA_DEST_ALLOCATED_PORT0;
+        nodeConfig.Init.TransferEventMode = DMA_TCEM_BLOCK_TRANSFER;
+        nodeConfig.Init.Mode = DMA_NORMAL;
+        nodeConfig.TriggerConfig.TriggerPolarity = DMA_TRIG_POLARITY_MASKED;
+        nodeConfig.DataHandlingConfig.DataExchange = DMA_EXCHANGE_NONE;
+        nodeConfig.DataHandlingConfig.DataAlignment = DMA_DATA_RIGHTALIGN_ZEROPADDED;
+        if (HAL_DMAEx_List_BuildNode(&nodeConfig, &node) != HAL_OK) {
+            while (1) {
+            }
+        }
+        if (HAL_DMAEx_List_InsertNode_Tail(&queue, &node) != HAL_OK) {
+            while (1) {
+            }
+        }
+        if (HAL_DMAEx_List_SetCircularMode(&queue) != HAL_OK) {
+            while (1) {
+            }
+        }
+
         handle.Instance = instance;
-        handle.Init.Request = request;
-        handle.Init.BlkHWRequest = DMA_BREQ_SINGLE_BURST;
-        handle.Init.Direction = DMA_MEMORY_TO_PERIPH;
-        handle.Init.SrcInc = DMA_SINC_INCREMENTED;
-        handle.Init.DestInc = DMA_DINC_FIXED;
-        handle.Init.SrcDataWidth = DMA_SRC_DATAWIDTH_BYTE;
-        handle.Init.DestDataWidth = DMA_DEST_DATAWIDTH_BYTE;
-        handle.Init.Priority = DMA_LOW_PRIORITY_LOW_WEIGHT;
-        handle.Init.SrcBurstLength = 1;
-        handle.Init.DestBurstLength = 1;
-        handle.Init.TransferAllocatedPort = DMA_SRC_ALLOCATED_PORT0 | DMA_DEST_ALLOCATED_PORT0;
-        handle.Init.TransferEventMode = DMA_TCEM_BLOCK_TRANSFER;
-        handle.Init.Mode = DMA_NORMAL;
-        if (HAL_DMA_Init(&handle) != HAL_OK) {
+        handle.InitLinkedList.Priority = DMA_HIGH_PRIORITY;
+        handle.InitLinkedList.LinkStepMode = DMA_LSM_FULL_EXECUTION;
+        handle.InitLinkedList.LinkAllocatedPort = DMA_LINK_ALLOCATED_PORT0;
+        handle.InitLinkedList.TransferEventMode = DMA_TCEM_BLOCK_TRANSFER;
+        handle.InitLinkedList.LinkedListMode = DMA_LINKEDLIST_CIRCULAR;
+        if (HAL_DMAEx_List_Init(&handle) != HAL_OK) {
+            while (1) {
+            }
+        }
+        if (HAL_DMAEx_List_LinkQ(&handle, &queue) != HAL_OK) {
             while (1) {
             }
         }
@@ -136,7 +168,7 @@ void HAL_SPI_MspInit(SPI_HandleTypeDef *hspi) {  // cppcheck-suppress constParam
         GPIO_InitStruct.Alternate = GPIO_AF5_SPI1;
         HAL_GPIO_Init(GPIOB, &GPIO_InitStruct);
 
-        dmaInit(handle_GPDMA1_Channel7, GPDMA1_Channel7, GPDMA1_REQUEST_SPI1_TX);
+        dmaInit(handle_GPDMA1_Channel7, node_GPDMA1_Channel7, queue_GPDMA1_Channel7, GPDMA1_Channel7, GPDMA1_REQUEST_SPI1_TX);
 
         HAL_NVIC_SetPriority(SPI1_IRQn, 0, 0);
         HAL_NVIC_EnableIRQ(SPI1_IRQn);
@@ -166,13 +198,94 @@ void HAL_SPI_MspInit(SPI_HandleTypeDef *hspi) {  // cppcheck-suppress constParam
         GPIO_InitStruct.Alternate = GPIO_AF5_SPI2;
         HAL_GPIO_Init(GPIOB, &GPIO_InitStruct);
 
-        dmaInit(handle_GPDMA2_Channel7, GPDMA2_Channel7, GPDMA1_REQUEST_SPI2_TX);
+        dmaInit(handle_GPDMA2_Channel7, node_GPDMA2_Channel7, queue_GPDMA2_Channel7, GPDMA2_Channel7, GPDMA1_REQUEST_SPI2_TX);
 
         HAL_NVIC_SetPriority(SPI2_IRQn, 0, 0);
         HAL_NVIC_EnableIRQ(SPI2_IRQn);
     }
 }
 
+void HAL_SPI_TxHalfCpltCallback(SPI_HandleTypeDef *hspi) {  // cppcheck-suppress constParameterPointer
+    if (hspi->Instance == SPI1) {
+        SPI_0::instance().halfSent(0);
+    } else if (hspi->Instance == SPI2) {
+        SPI_1::instance().halfSent(0);
+    }
+}
+
+void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef *hspi) {  // cppcheck-suppress constParameterPointer
+    if (hspi->Instance == SPI1) {
+        SPI_0::instance().halfSent(1);
+    } else if (hspi->Instance == SPI2) {
+        SPI_1::instance().halfSent(1);
+    }
+}
+
+void HAL_SPI_AbortCpltCallback(SPI_HandleTypeDef *hspi) {  // cppcheck-suppress constParameterPointer
+    if (hspi->Instance == SPI1) {
+        SPI_0::instance().stopped();
+    } else if (hspi->Instance == SPI2) {
+        SPI_1::instance().stopped();
+    }
+}
+
+void HAL_SPI_ErrorCallback(SPI_HandleTypeDef *hspi) {  // cppcheck-suppress constParameterPointer
+    HAL_SPI_AbortCpltCallback(hspi);
+}
+
+void SPI::stream(const uint8_t *buf, size_t len, uint32_t transferMbps, bool wantsSCLK) {
+    cbuf = buf;
+    clen = len;
+    target_mbps = transferMbps;
+    target_sclk = wantsSCLK;
+    dmaActive = true;
+    if (mbps != target_mbps || sclk != target_sclk) {
+        // PLL reconfiguration is not safe from an interrupt, leave it to update()
+        if (__get_IPSR() != 0) {
+            scheduleDMA = true;
+            return;
+        }
+        mbps = target_mbps;
+        sclk = target_sclk;
+        PLLQCalcMulDiv();
+        setupDMATransfer();
+    }
+    start();
+}
+
+void SPI::update() {
+    if (!scheduleDMA) {
+        return;
+    }
+    scheduleDMA = false;
+    mbps = target_mbps;
+    sclk = target_sclk;
+    PLLQCalcMulDiv();
+    setupDMATransfer();
+    start();
+}
+
+void SPI::start() {
+    if (!startDMATransfer()) {
+        stopped();
+    }
+}
+
+void SPI::stop() { stopDMATransfer(); }
+
+void SPI::halfSent(size_t half) {
+    if (halfSentFunc) {
+        halfSentFunc(half);
+    }
+}
+
+void SPI::stopped() {
+    dmaActive = false;
+    if (stoppedFunc) {
+        stoppedFunc();
+    }
+}
+
 static void InitSPI(SPI_HandleTypeDef &handle, SPI_TypeDef *instance) {
     handle.Instance = instance;
     handle.Init.Mode = SPI_MODE_MASTER;
@@ -211,22 +324,18 @@ SPI &SPI_0::instance() {
     return spi;
 }
 
-static void SPI1_IT_Callback(DMA_HandleTypeDef *) { SPI_0::instance().setDMAActive(false); }
+bool SPI_0::startDMATransfer() { return HAL_SPI_Transmit_DMA(&hspi1, cbuf, uint16_t(clen)) == HAL_OK; }
 
-void SPI_0::startDMATransfer() { HAL_SPI_Transmit_DMA(&hspi1, cbuf, uint16_t(clen)); }
+void SPI_0::stopDMATransfer() { HAL_SPI_Abort_IT(&hspi1); }
 
 void SPI_0::setupDMATransfer() { configSPI1Clock(mul, div); }
 
-bool SPI_0::isDMAbusy() const { return ((handle_GPDMA1_Channel7.Instance->CSR & DMA_CSR_IDLEF) == 0); }
-
 void SPI_0::init() {
     __HAL_RCC_GPDMA1_CLK_ENABLE();
     HAL_NVIC_SetPriority(GPDMA1_Channel7_IRQn, 0, 0);
     HAL_NVIC_EnableIRQ(GPDMA1_Channel7_IRQn);
 
     InitSPI(hspi1, SPI1);
-
-    HAL_DMA_RegisterCallback(&handle_GPDMA1_Channel7, HAL_DMA_XFER_CPLT_CB_ID, &SPI1_IT_Callback);
 }
 
 SPI &SPI_1::instance() {
@@ -238,20 +347,16 @@ SPI &SPI_1::instance() {
     return spi;
 }
 
-static void SPI2_IT_Callback(DMA_HandleTypeDef *) { SPI_1::instance().setDMAActive(false); }
+bool SPI_1::startDMATransfer() { return HAL_SPI_Transmit_DMA(&hspi2, cbuf, uint16_t(clen)) == HAL_OK; }
 
-void SPI_1::startDMATransfer() { HAL_SPI_Transmit_DMA(&hspi2, cbuf, uint16_t(clen)); }
+void SPI_1::stopDMATransfer() { HAL_SPI_Abort_IT(&hspi2); }
 
 void SPI_1::setupDMATransfer() { configSPI2Clock(mul, div); }
 
-bool SPI_1::isDMAbusy() const { return ((handle_GPDMA2_Channel7.Instance->CSR & DMA_CSR_IDLEF) == 0); }
-
 void SPI_1::init() {
     __HAL_RCC_GPDMA2_CLK_ENABLE();
     HAL_NVIC_SetPriority(GPDMA2_Channel7_IRQn, 0, 0);
     HAL_NVIC_EnableIRQ(GPDMA2_Channel7_IRQn);
 
     InitSPI(hspi2, SPI2);
-
-    HAL_DMA_RegisterCallback(&handle_GPDMA2_Channel7, HAL_DMA_XFER_CPLT_CB_ID, &SPI2_IT_Callback);
 }
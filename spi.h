@@ -26,39 +26,23 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <stdint.h>
 #include <stdlib.h>
 
+#include <functional>
+
 class SPI {
    public:
-    void transfer(const uint8_t *buf, size_t len, uint32_t transferMbps, bool wantsSCLK) {
-        if (dmaActive) {
-            if (isDMAbusy()) {
-                scheduleDMA = true;
-                return;
-            }
-        }
-
-        dmaActive = false;
-        if (cbuf != buf || clen != len || mbps != transferMbps || wantsSCLK != sclk) {
-            cbuf = buf;
-            clen = len;
-            mbps = transferMbps;
-            PLLQCalcMulDiv();
-            sclk = wantsSCLK;
-            setupDMATransfer();
-        }
-        startDMATransfer();
-        dmaActive = true;
-    };
-
-    void update() {
-        if (scheduleDMA) {
-            scheduleDMA = false;
-            transfer(cbuf, clen, mbps, sclk);
-        }
-    }
+    // Sends buf in a loop until stop() is called; halfSentFunc is called from the DMA interrupt with the half
+    // of buf that just went out so it can be refilled.
+    void stream(const uint8_t *buf, size_t len, uint32_t transferMbps, bool wantsSCLK);
+    void stop();
+    void update();
 
-    void setDMAActive(bool state) { dmaActive = false; }
+    void halfSent(size_t half);
+    void stopped();
+    void setDMAActive(bool state) { dmaActive = state; }
+    bool isDMAActive() const { return dmaActive; }
 
-    virtual bool isDMAbusy() const = 0;
+    std::function<void(size_t half)> halfSentFunc{};
+    std::function<void()> stoppedFunc{};
 
    protected:
     void PLLQCalcMulDiv() {
@@ -80,22 +64,27 @@ class SPI {
         actual_mbps = ((base_freq * mul) / div) / 2;
     }
 
+    void start();
+
     size_t clen = 0;
     const uint8_t *cbuf = 0;
 
-    bool scheduleDMA = false;
-    bool dmaActive = false;
+    volatile bool scheduleDMA = false;
+    volatile bool dmaActive = false;
     bool sclk = false;
     bool fast = true;
 
     uint32_t mul = 1;
     uint32_t div = 1;
-    uint32_t mbps = 40000000;
+    uint32_t mbps = 0;
     uint32_t actual_mbps = 40000000;
+    uint32_t target_mbps = 0;
+    bool target_sclk = false;
 
     virtual ~SPI(){};
     bool initialized = false;
-    virtual void startDMATransfer() = 0;
+    virtual bool startDMATransfer() = 0;
+    virtual void stopDMATransfer() = 0;
     virtual void setupDMATransfer() = 0;
     virtual void init() = 0;
 };
@@ -103,8 +92,8 @@ class SPI {
 class SPI_0 : public SPI {
    public:
     static SPI &instance();
-    virtual bool isDMAbusy() const override;
-    virtual void startDMATransfer() override;
+    virtual bool startDMATransfer() override;
+    virtual void stopDMATransfer() override;
     virtual void setupDMATransfer() override;
 
    protected:
@@ -115,8 +104,8 @@ class SPI_0 : public SPI {
 class SPI_1 : public SPI {
    public:
     static SPI &instance();
-    virtual bool isDMAbusy() const override;
-    virtual void startDMATransfer() override;
+    virtual bool startDMATransfer() override;
+    virtual void stopDMATransfer() override;
     virtual void setupDMATransfer() override;
 
    protected:
@@ -32,6 +32,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "./color.h"
 #include "./model.h"
+#include "./systick.h"
 #include "./utils.h"
 
 #define __assume(cond)                        \
@@ -50,47 +51,89 @@ static constexpr std::array<uint16_t, ws2816b_error_extent_n> make_ws2816b_error
 
 static ColorSpaceConverter converter;
 
-class manchester_bit_buf {
-   public:
-    explicit manchester_bit_buf(uint8_t *p) {
-        buf = p;
-        byte = 0;
-        bit_pos = 7;
-        byte_pos = 0;
-        man_pos = 0;
+// Cheap word-at-a-time payload hash; only used to spot universes that arrive unchanged
+__attribute__((hot, optimize("O3"))) static uint32_t payload_hash(const uint8_t *data, size_t len, uint32_t seed) {
+    uint32_t h = seed ^ uint32_t(len);
+    size_t c = 0;
+    for (; c + 4 <= len; c += 4) {
+        uint32_t w = 0;
+        memcpy(&w, &data[c], sizeof(w));
+        h = (h ^ w) * 0x9E3779B1;
+        h ^= h >> 15;
     }
+    for (; c < len; c++) {
+        h = (h ^ data[c]) * 0x01000193;
+    }
+    h ^= h >> 16;
+    h *= 0x85EBCA6B;
+    h ^= h >> 13;
+    return h;
+}
 
-    __attribute__((hot, optimize("O2"))) void push(uint32_t bits, int32_t count) {
-        for (int32_t c = 0; c < count; c++) {
-            for (int32_t d = 0; d < 2; d++) {
-                byte |= ((man_pos & 1) ^ ((bits & (1UL << 31)) ? 1 : 0)) ? (1UL << bit_pos) : 0;
-                bit_pos--;
-                if (bit_pos < 0) {
-                    buf[byte_pos++] = byte;
-                    byte = 0;
-                    bit_pos = 7;
+// WS2812 bit cells: every source bit becomes a nibble, 1 -> 1100, 0 -> 1000; two bits per output byte, MSB first.
+static constexpr uint32_t ws2812_encode(uint32_t c) {
+    return 0x88888888 | (((c >> 4) | (c << 6) | (c << 16) | (c << 26)) & 0x04040404) | (((c >> 1) | (c << 9) | (c << 19) | (c << 29)) & 0x40404040);
+}
+
+// Four source bytes at once: row k collects bit pair 3-k of every byte, then a 4x4 byte transpose yields one word per byte.
+static constexpr std::array<uint32_t, 4> ws2812_encode4(uint32_t s) {
+    std::array<uint32_t, 4> e{};
+    for (size_t k = 0; k < 4; k++) {
+        uint32_t p = (s >> (6 - 2 * k)) & 0x03030303;
+        e[k] = 0x88888888 | ((p << 5) & 0x40404040) | ((p << 2) & 0x04040404);
+    }
+    uint32_t a = (e[0] & 0x00FF00FF) | ((e[1] & 0x00FF00FF) << 8);
+    uint32_t b = ((e[0] >> 8) & 0x00FF00FF) | (e[1] & 0xFF00FF00);
+    uint32_t c = (e[2] & 0x00FF00FF) | ((e[3] & 0x00FF00FF) << 8);
+    uint32_t d = ((e[2] >> 8) & 0x00FF00FF) | (e[3] & 0xFF00FF00);
+#ifdef __ARM_FEATURE_DSP
+    if !consteval {
+        return {__PKHBT(a, c, 16), __PKHBT(b, d, 16), __PKHTB(c, a, 16), __PKHTB(d, b, 16)};
+    }
+#endif  // #ifdef __ARM_FEATURE_DSP
+    return {(a & 0x0000FFFF) | (c << 16), (b & 0x0000FFFF) | (d << 16), (c & 0xFFFF0000) | (a >> 16), (d & 0xFFFF0000) | (b >> 16)};
+}
+
+static constexpr bool ws2812_encode4_exact() {
+    for (uint32_t v = 0; v < 256; v++) {
+        for (uint32_t fill : {0x00U, 0x5AU, 0xA5U, 0xFFU}) {
+            for (size_t lane = 0; lane < 4; lane++) {
+                std::array<uint32_t, 4> src{fill, fill, fill, fill};
+                src[lane] = v;
+                auto out = ws2812_encode4(src[0] | (src[1] << 8) | (src[2] << 16) | (src[3] << 24));
+                for (size_t c = 0; c < 4; c++) {
+                    if (out[c] != ws2812_encode(src[c])) {
+                        return false;
+                    }
                 }
-                man_pos++;
             }
-            bits <<= 1;
         }
     }
+    return true;
+}
+static_assert(ws2812_encode4_exact());
+
+// Compact NRZ: three SPI bits per source bit, 1 -> 110, 0 -> 100; 24 bits per byte, MSB first.
+static constexpr uint32_t ws2812_encode3(uint32_t c) {
+    c = (c | (c << 8)) & 0x00F00F;
+    c = (c | (c << 4)) & 0x0C30C3;
+    c = (c | (c << 2)) & 0x249249;
+    return 0x924924 | (c << 1);
+}
 
-    void flush() {
-        buf[byte_pos++] = byte;
-        byte = 0;
-        bit_pos = 7;
+// Manchester, MSB first: 1 -> 10, 0 -> 01; one source byte to 16 line bits
+static constexpr std::array<uint16_t, 256> manchester_lut = []() constexpr {
+    std::array<uint16_t, 256> table{};
+    for (uint32_t c = 0; c < 256; c++) {
+        uint32_t x = c;
+        x = (x | (x << 4)) & 0x0F0F;
+        x = (x | (x << 2)) & 0x3333;
+        x = (x | (x << 1)) & 0x5555;
+        table[c] = uint16_t((x << 1) | (~x & 0x5555));
     }
-
-    size_t len() { return byte_pos; }
-
-   private:
-    uint8_t *buf = 0;
-    uint8_t byte = 0;
-    size_t byte_pos = 0;
-    int32_t bit_pos = 0;
-    int32_t man_pos = 0;
-};
+    return table;
+}();
+static_assert(manchester_lut[0x00] == 0x5555 && manchester_lut[0xFF] == 0xAAAA && manchester_lut[0x80] == 0x9555);
 
 Strip &Strip::get(size_t index) {
     static Strip strips[Model::stripN];
@@ -104,31 +147,28 @@ Strip &Strip::get(size_t index) {
     return strips[index % Model::stripN];
 }
 
-bool Strip::ws2812_lut_init = false;
-std::array<uint32_t, 256> Strip::ws2812_lut;
 bool Strip::hd108_lut_init = false;
 std::array<std::array<uint16_t, 256>, 3> Strip::hd108_lut;
 
 void Strip::init() {
-    comp_buf.fill(0);
-    spi_buf.fill(0);
+    for (auto &slot : frame_slots) {
+        slot.fill(0);
+    }
+    write_slot = 0;
+    encode_slot = 1;
+    ready_slot = 2;
+    free_slots = uint8_t(((1U << slotN) - 1) & ~0x07U);
+    queue_head = 0;
+    queue_count = 0;
+    comp_buf = frame_slots[write_slot].data();
+    frame_buf = frame_slots[encode_slot].data();
+    stream_buf.fill(0);
+    universe_hash_valid = 0;
     transfer_flag = false;
     RGBColorSpace rgbSpace;
     rgbSpace.setsRGB();
     converter.setRGBColorSpace(rgbSpace);
-    if (!ws2812_lut_init) {
-        ws2812_lut_init = true;
-        auto make_ws2812_table = []() constexpr -> std::array<uint32_t, 256> {
-            std::array<uint32_t, 256> table{};
-            for (uint32_t c = 0; c < 256; c++) {
-                table[c] =
-                    0x88888888 | (((c >> 4) | (c << 6) | (c << 16) | (c << 26)) & 0x04040404) | (((c >> 1) | (c << 9) | (c << 19) | (c << 29)) & 0x40404040);
-            }
-            return table;
-        };
-        // Make a RAM copy; gets us a slight perf improvement
-        ws2812_lut = make_ws2812_table();
-    }
+    selectUniverseKernels();
     if (!hd108_lut_init) {
         hd108_lut_init = true;
         auto make_hd108_table = []() constexpr -> std::array<std::array<uint16_t, 256>, 3> {
@@ -162,7 +202,10 @@ void Strip::init() {
     printf(ESCAPE_FG_CYAN "Strip up.\n");
 }
 
-void Strip::setRGBColorSpace(const RGBColorSpace &colorSpace) { converter.setRGBColorSpace(colorSpace); }
+void Strip::setRGBColorSpace(const RGBColorSpace &colorSpace) {
+    converter.setRGBColorSpace(colorSpace);
+    universe_hash_valid = 0;
+}
 
 size_t Strip::getBytesPerPixel() const { return Model::stripOutputProperties[output_type].bytes_per_pixel; }
 
@@ -170,6 +213,28 @@ Model::StripConfig::StripNativeType Strip::nativeType() const { return Model::st
 
 bool Strip::needsClock() const { return Model::stripOutputProperties[output_type].has_clock; }
 
+bool Strip::nrz3Bit() const {
+    if (nrz_bits != 3) {
+        return false;
+    }
+    switch (output_type) {
+        case Model::StripConfig::SK6812:
+        case Model::StripConfig::SK6812_RGBW:
+        case Model::StripConfig::WS2811:
+        case Model::StripConfig::WS2812:
+        case Model::StripConfig::WS2816:
+        case Model::StripConfig::TM1804:
+        case Model::StripConfig::UCS1904:
+        case Model::StripConfig::TM1829:
+        case Model::StripConfig::GS8202: {
+            return true;
+        } break;
+        default: {
+            return false;
+        } break;
+    }
+}
+
 size_t Strip::getPixelLen() const {
     const size_t pixsize = getBytesPerPixel();
     return bytes_len / pixsize;
@@ -195,7 +260,79 @@ size_t Strip::getMaxBytesLen() const {
 
 void Strip::setBytesLen(size_t len) {
     bytes_len = std::min(getMaxBytesLen(), size_t(len));
-    memset(&comp_buf.data()[bytes_len], 0, comp_buf.size() - bytes_len);
+    memset(&comp_buf[bytes_len], 0, bytesMaxLen - bytes_len);
+    universe_hash_valid = 0;
+    markDirty(bytes_len, bytesMaxLen);
+}
+
+void Strip::markDirty(size_t start, size_t end) {
+    // The other two slots are now stale in this span
+    for (size_t c = 0; c < slotN; c++) {
+        if (c != write_slot) {
+            slot_stale[c].start = std::min(slot_stale[c].start, start);
+            slot_stale[c].end = std::max(slot_stale[c].end, end);
+        }
+    }
+}
+
+void Strip::publishFrame() {
+    const uint8_t published = write_slot;
+    write_slot = publishSlot(published);
+    catchUpWriteSlot(published);
+}
+
+uint8_t Strip::publishSlot(uint8_t slot) {
+    const uint8_t prev = ready_slot.exchange(uint8_t(slot | slotFresh));
+    if (prev & slotFresh) {
+        overwritten_frames++;
+    }
+    return prev & slotMask;
+}
+
+void Strip::catchUpWriteSlot(uint8_t from) {
+    // The new write slot missed everything written since it last held the frame; copy that span from the latest one
+    Span &stale = slot_stale[write_slot];
+    if (stale.start < stale.end) {
+        memcpy(&frame_slots[write_slot][stale.start], &frame_slots[from][stale.start], stale.end - stale.start);
+    }
+    stale = Span{};
+    comp_buf = frame_slots[write_slot].data();
+}
+
+void Strip::queueFrame(uint64_t due) {
+    const uint64_t now = Systick::instance().systemTimeRAW();
+    presentDue(now);
+    if (Systick::reached(now, due)) {
+        late_frames++;
+        transfer();
+        return;
+    }
+    if (queue_count == queueN) {
+        // Sender runs further ahead than we can hold
+        early_frames++;
+        presentNext();
+    }
+    const uint8_t queued = write_slot;
+    frame_queue[(queue_head + queue_count) % queueN] = {queued, due};
+    queue_count++;
+    write_slot = uint8_t(__builtin_ctz(free_slots));
+    free_slots &= uint8_t(~(1U << write_slot));
+    catchUpWriteSlot(queued);
+}
+
+void Strip::presentNext() {
+    const uint8_t slot = frame_queue[queue_head].slot;
+    queue_head = (queue_head + 1) % queueN;
+    queue_count--;
+    free_slots |= uint8_t(1U << publishSlot(slot));
+    streamStart();
+}
+
+uint64_t Strip::presentDue(uint64_t now) {
+    while (queue_count > 0 && Systick::reached(now, frame_queue[queue_head].due)) {
+        presentNext();
+    }
+    return queue_count > 0 ? frame_queue[queue_head].due : UINT64_MAX;
 }
 
 bool Strip::isUniverseActive(size_t uniN, Model::StripConfig::StripInputType input_type) const {
@@ -230,12 +367,7 @@ void Strip::setData(const uint8_t *data, const size_t len, const Model::StripCon
     }
 }
 
-__attribute__((hot, optimize("O3"), optimize("unroll-loops"))) void Strip::setUniverseData(const size_t uniN, const uint8_t *data, const size_t len,
-                                                                                           const Model::StripConfig::StripInputType input_type) {
-    __assume(uniN < Model::universeN);
-    __assume(len <= 512);
-    __assume(input_type < magic_enum::enum_count<Model::StripConfig::StripInputType>());
-
+void Strip::setUniverseData(const size_t uniN, const uint8_t *data, const size_t len, const Model::StripConfig::StripInputType input_type) {
     if (uniN >= Model::universeN) {
         return;
     }
@@ -244,26 +376,80 @@ __attribute__((hot, optimize("O3"), optimize("unroll-loops"))) void Strip::setUn
         return;
     }
 
-    auto order = Model::stripOutputProperties[output_type].rgbw_order;
-    const uint32_t limit_8bit = uint32_t(std::clamp(comp_limit, 0.0f, 1.0f) * 255.f);
-    const uint32_t limit_16bit = uint32_t(std::clamp(comp_limit, 0.0f, 1.0f) * 65535.f);
+    const uint32_t hash = payload_hash(data, len, uint32_t(input_type));
+    if ((universe_hash_valid & (1UL << uniN)) && universe_hash[uniN] == hash) {
+        unchanged_universes++;
+        return;
+    }
+
     const size_t input_size = getBytesPerInputPixel(input_type);
-    const size_t pixel_pad = std::min(getComponentsPerInputPixel(input_type), order.size());
-    const size_t input_pad = size_t(dmxMaxLen / input_size) * order.size() * getComponentBytes(input_type);
+    const size_t input_pad = size_t(dmxMaxLen / input_size) * Model::stripOutputProperties[output_type].rgbw_order.size() * getComponentBytes(input_type);
+    const size_t start = input_pad * uniN;
+
+    (this->*universe_kernels[input_type % universe_kernels.size()])(start, data, len);
+
+    universe_hash[uniN] = hash;
+    universe_hash_valid |= (1UL << uniN);
+
+    const size_t pixels = (std::min(len, input_pad) + input_size - 1) / input_size;
+    const size_t comp_bytes = nativeType() == Model::StripConfig::NATIVE_RGB16 ? 2 : 1;
+    markDirty(start, std::min(bytes_len, start + pixels * Model::stripOutputProperties[output_type].rgbw_order.size() * comp_bytes));
+}
+
+void Strip::setPixelData(const size_t offset, const uint8_t *data, const size_t len, const Model::StripConfig::StripInputType input_type) {
+    const size_t input_size = getBytesPerInputPixel(input_type);
+    const size_t pixpad = size_t(dmxMaxLen / input_size);
+    const size_t input_pad = pixpad * Model::stripOutputProperties[output_type].rgbw_order.size() * getComponentBytes(input_type);
+    const size_t comp_bytes = nativeType() == Model::StripConfig::NATIVE_RGB16 ? 2 : 1;
+    const size_t output_size = Model::stripOutputProperties[output_type].rgbw_order.size() * comp_bytes;
+
+    // Pixels keep the same place in comp_buf as when they arrive by universe, so both paths can be mixed
+    size_t pixel = (offset + input_size - 1) / input_size;
+    size_t pos = pixel * input_size - offset;
+    const size_t pixel_end = std::min(getPixelLen(), (offset + len) / input_size);
+    while (pixel < pixel_end) {
+        const size_t uniN = pixel / pixpad;
+        if (uniN >= Model::universeN) {
+            break;
+        }
+        const size_t first = pixel % pixpad;
+        const size_t count = std::min(pixel_end - pixel, pixpad - first);
+        const size_t start = input_pad * uniN + first * output_size;
+
+        (this->*universe_kernels[input_type % universe_kernels.size()])(start, data + pos, count * input_size);
+
+        universe_hash_valid &= ~uint32_t(1UL << uniN);
+        markDirty(start, std::min(bytes_len, start + count * output_size));
+
+        pixel += count;
+        pos += count * input_size;
+    }
+}
+
+template <Model::StripConfig::StripInputType IN, Model::StripConfig::StripOutputType OUT, bool LIMITED>
+__attribute__((hot, optimize("O3"), optimize("unroll-loops"))) void Strip::setUniverseDataKernel(const size_t start, const uint8_t *data, const size_t len) {
+    __assume(start < bytesMaxLen);
+    __assume(len <= 512);
+
+    constexpr Model::StripConfig::StripInputType input_type = IN;
+    constexpr Model::StripConfig::StripNativeType native = Model::stripOutputProperties[OUT].native_type;
+    constexpr auto order = Model::stripOutputProperties[OUT].rgbw_order;
+    const uint32_t limit_8bit = LIMITED ? uint32_t(std::clamp(comp_limit, 0.0f, 1.0f) * 255.f) : 255;
+    const uint32_t limit_16bit = LIMITED ? uint32_t(std::clamp(comp_limit, 0.0f, 1.0f) * 65535.f) : 65535;
+    constexpr size_t input_size = Model::stripInputProperties[IN].bytes_per_pixel;
+    constexpr size_t pixel_pad = std::min(size_t(Model::stripInputProperties[IN].comp_per_pixel), order.size());
+    constexpr size_t input_pad = size_t(dmxMaxLen / input_size) * order.size() * Model::stripInputProperties[IN].bytes_per_comp;
     const size_t pixel_loop_n = std::min(len, input_pad);
-    const size_t order_size = order.size();
+    constexpr size_t order_size = order.size();
 
     __assume(pixel_loop_n > 0);
 
     __assume(limit_8bit <= 255);
     __assume(limit_16bit <= 65535);
 
-    __assume(input_size > 0);
-    __assume(pixel_pad > 0);
-    __assume(input_size <= 8);
-    __assume(pixel_pad <= 4);
-    __assume(input_pad > 0);
-    __assume(input_pad < dmxMaxLen);
+    static_assert(input_size > 0 && input_size <= 8);
+    static_assert(pixel_pad > 0 && pixel_pad <= 4);
+    static_assert(input_pad > 0);
 
     auto fix_for_ws2816b = [=](const uint16_t v) {
         static constexpr auto lut = make_ws2816b_error_lut();
@@ -276,11 +462,11 @@ __attribute__((hot, optimize("O3"), optimize("unroll-loops"))) void Strip::setUn
     switch (input_type) {
         default:
         case Model::StripConfig::RGB8: {
-            switch (nativeType()) {
+            switch (native) {
                 default: {
                 } break;
                 case Model::StripConfig::NATIVE_RGB8: {
-                    uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[input_pad * uniN]);  // cppcheck-suppress constVariablePointer
+                    uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[start]);  // cppcheck-suppress constVariablePointer
                     for (size_t c = 0, n = 0; c < pixel_loop_n; c += 3, n += order_size) {
                         for (size_t d = 0; d < pixel_pad; d++) {
                             buf[n + order[d]] = uint8_t(std::min(limit_8bit, uint32_t(data[c + d])));
@@ -288,7 +474,7 @@ __attribute__((hot, optimize("O3"), optimize("unroll-loops"))) void Strip::setUn
                     }
                 } break;
                 case Model::StripConfig::NATIVE_RGBW8: {
-                    uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[input_pad * uniN]);  // cppcheck-suppress constVariablePointer
+                    uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[start]);  // cppcheck-suppress constVariablePointer
                     for (size_t c = 0, n = 0; c < pixel_loop_n; c += 3, n += 4) {
                         uint32_t r = std::min(limit_8bit, uint32_t(data[c + 0]));
                         uint32_t g = std::min(limit_8bit, uint32_t(data[c + 1]));
@@ -301,8 +487,8 @@ __attribute__((hot, optimize("O3"), optimize("unroll-loops"))) void Strip::setUn
                     }
                 } break;
                 case Model::StripConfig::NATIVE_RGB16: {
-                    if (output_type == Model::StripConfig::WS2816) {
-                        uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[input_pad * uniN]);  // cppcheck-suppress constVariablePointer
+                    if (OUT == Model::StripConfig::WS2816) {
+                        uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[start]);  // cppcheck-suppress constVariablePointer
                         for (size_t c = 0, n = 0; c < pixel_loop_n; c += 3, n += 3) {
                             auto read_buf = [=](const size_t i) {
                                 uint32_t v = uint32_t(data[c + i]);
@@ -319,8 +505,8 @@ __attribute__((hot, optimize("O3"), optimize("unroll-loops"))) void Strip::setUn
                         }
                         return;
                     }
-                    if (output_type == Model::StripConfig::HD108) {
-                        uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[input_pad * uniN]);  // cppcheck-suppress constVariablePointer
+                    if (OUT == Model::StripConfig::HD108) {
+                        uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[start]);  // cppcheck-suppress constVariablePointer
                         for (size_t c = 0, n = 0; c < pixel_loop_n; c += 3, n += 3) {
                             auto read_buf = [=](const size_t i) {
                                 uint32_t v = uint32_t(data[c + i]);
@@ -344,11 +530,11 @@ __attribute__((hot, optimize("O3"), optimize("unroll-loops"))) void Strip::setUn
             }
         } break;
         case Model::StripConfig::RGBW8: {
-            switch (nativeType()) {
+            switch (native) {
                 default: {
                 } break;
                 case Model::StripConfig::NATIVE_RGB8: {
-                    uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[input_pad * uniN]);  // cppcheck-suppress constVariablePointer
+                    uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[start]);  // cppcheck-suppress constVariablePointer
                     for (size_t c = 0, n = 0; c < pixel_loop_n; c += 4, n += 3) {
                         uint32_t r = uint32_t(data[c + 0]);
                         uint32_t g = uint32_t(data[c + 1]);
@@ -361,7 +547,7 @@ __attribute__((hot, optimize("O3"), optimize("unroll-loops"))) void Strip::setUn
                     }
                 } break;
                 case Model::StripConfig::NATIVE_RGBW8: {
-                    uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[input_pad * uniN]);  // cppcheck-suppress constVariablePointer
+                    uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[start]);  // cppcheck-suppress constVariablePointer
                     for (size_t c = 0, n = 0; c < pixel_loop_n; c += 4, n += order_size) {
                         for (size_t d = 0; d < pixel_pad; d++) {
                             buf[n + order[d]] = uint8_t(std::min(limit_8bit, uint32_t(data[c + d])));
@@ -369,8 +555,8 @@ __attribute__((hot, optimize("O3"), optimize("unroll-loops"))) void Strip::setUn
                     }
                 } break;
                 case Model::StripConfig::NATIVE_RGB16: {
-                    if (output_type == Model::StripConfig::WS2816) {
-                        uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[input_pad * uniN]);  // cppcheck-suppress constVariablePointer
+                    if (OUT == Model::StripConfig::WS2816) {
+                        uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[start]);  // cppcheck-suppress constVariablePointer
                         for (size_t c = 0, n = 0; c < pixel_loop_n; c += 4, n += 3) {
                             auto read_buf = [=](const size_t i) {
                                 uint32_t v = uint32_t(data[c + i]);
@@ -396,8 +582,8 @@ __attribute__((hot, optimize("O3"), optimize("unroll-loops"))) void Strip::setUn
                         }
                         return;
                     }
-                    if (output_type == Model::StripConfig::HD108) {
-                        uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[input_pad * uniN]);  // cppcheck-suppress constVariablePointer
+                    if (OUT == Model::StripConfig::HD108) {
+                        uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[start]);  // cppcheck-suppress constVariablePointer
                         for (size_t c = 0, n = 0; c < pixel_loop_n; c += 4, n += 3) {
                             auto read_buf = [=](const size_t i) {
                                 uint32_t v = uint32_t(data[c + i]);
@@ -430,11 +616,11 @@ __attribute__((hot, optimize("O3"), optimize("unroll-loops"))) void Strip::setUn
             }
         } break;
         case Model::StripConfig::RGB8_SRGB: {
-            switch (nativeType()) {
+            switch (native) {
                 default: {
                 } break;
                 case Model::StripConfig::NATIVE_RGB8: {
-                    uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[input_pad * uniN]);  // cppcheck-suppress constVariablePointer
+                    uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[start]);  // cppcheck-suppress constVariablePointer
                     for (size_t c = 0, n = 0; c < pixel_loop_n; c += 3, n += 3) {
                         uint8_t sr = data[c + 0];
                         uint8_t sg = data[c + 1];
@@ -456,7 +642,7 @@ __attribute__((hot, optimize("O3"), optimize("unroll-loops"))) void Strip::setUn
                     }
                 } break;
                 case Model::StripConfig::NATIVE_RGBW8: {
-                    uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[input_pad * uniN]);  // cppcheck-suppress constVariablePointer
+                    uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[start]);  // cppcheck-suppress constVariablePointer
                     for (size_t c = 0, n = 0; c < pixel_loop_n; c += 3, n += 3) {
                         uint8_t sr = data[c + 0];
                         uint8_t sg = data[c + 1];
@@ -482,11 +668,11 @@ __attribute__((hot, optimize("O3"), optimize("unroll-loops"))) void Strip::setUn
                     }
                 } break;
                 case Model::StripConfig::NATIVE_RGB16: {
-                    if (output_type == Model::StripConfig::WS2816) {
-                        uint16_t *buf = reinterpret_cast<uint16_t *>(uintptr_t(&comp_buf[input_pad * uniN]));
+                    if (OUT == Model::StripConfig::WS2816) {
+                        uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[start]);  // cppcheck-suppress constVariablePointer
                         for (size_t c = 0, n = 0; c < pixel_loop_n; c += 3, n += 3) {
                             auto write_buf = [=](const size_t i, const uint16_t p) {
-                                *reinterpret_cast<uint16_t *>(&buf[(n + i) * 2]) = __builtin_bswap16(uint16_t(p));
+                                *reinterpret_cast<uint16_t *>(uintptr_t(&buf[(n + i) * 2])) = __builtin_bswap16(uint16_t(p));
                             };
 
                             uint8_t sr = data[c + 0];
@@ -509,11 +695,11 @@ __attribute__((hot, optimize("O3"), optimize("unroll-loops"))) void Strip::setUn
                         }
                         return;
                     }
-                    if (output_type == Model::StripConfig::HD108) {
-                        uint16_t *buf = reinterpret_cast<uint16_t *>(uintptr_t(&comp_buf[input_pad * uniN]));
+                    if (OUT == Model::StripConfig::HD108) {
+                        uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[start]);  // cppcheck-suppress constVariablePointer
                         for (size_t c = 0, n = 0; c < pixel_loop_n; c += 3, n += 3) {
                             auto write_buf = [=](const size_t i, const uint16_t p) {
-                                *reinterpret_cast<uint16_t *>(&buf[(n + i) * 2]) = __builtin_bswap16(uint16_t(p));
+                                *reinterpret_cast<uint16_t *>(uintptr_t(&buf[(n + i) * 2])) = __builtin_bswap16(uint16_t(p));
                             };
 
                             uint8_t sr = data[c + 0];
@@ -542,11 +728,11 @@ __attribute__((hot, optimize("O3"), optimize("unroll-loops"))) void Strip::setUn
             }
         } break;
         case Model::StripConfig::RGBW_SRGB: {
-            switch (nativeType()) {
+            switch (native) {
                 default: {
                 } break;
                 case Model::StripConfig::NATIVE_RGB8: {
-                    uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[input_pad * uniN]);  // cppcheck-suppress constVariablePointer
+                    uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[start]);  // cppcheck-suppress constVariablePointer
                     for (size_t c = 0, n = 0; c < pixel_loop_n; c += 4, n += 3) {
                         uint8_t sr = uint8_t(data[c + 0]);
                         uint8_t sg = uint8_t(data[c + 1]);
@@ -565,7 +751,7 @@ __attribute__((hot, optimize("O3"), optimize("unroll-loops"))) void Strip::setUn
                     }
                 } break;
                 case Model::StripConfig::NATIVE_RGBW8: {
-                    uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[input_pad * uniN]);  // cppcheck-suppress constVariablePointer
+                    uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[start]);  // cppcheck-suppress constVariablePointer
                     for (size_t c = 0, n = 0; c < pixel_loop_n; c += 4, n += 4) {
                         uint8_t sr = uint8_t(data[c + 0]);
                         uint8_t sg = uint8_t(data[c + 1]);
@@ -585,11 +771,11 @@ __attribute__((hot, optimize("O3"), optimize("unroll-loops"))) void Strip::setUn
                     }
                 } break;
                 case Model::StripConfig::NATIVE_RGB16: {
-                    if (output_type == Model::StripConfig::WS2816) {
-                        uint16_t *buf = reinterpret_cast<uint16_t *>(uintptr_t(&comp_buf[input_pad * uniN]));
+                    if (OUT == Model::StripConfig::WS2816) {
+                        uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[start]);  // cppcheck-suppress constVariablePointer
                         for (size_t c = 0, n = 0; c < pixel_loop_n; c += 4, n += 3) {
                             auto write_buf = [=](const size_t i, const uint16_t p) {
-                                *reinterpret_cast<uint16_t *>(&buf[(n + i) * 2]) = __builtin_bswap16(uint16_t(p));
+                                *reinterpret_cast<uint16_t *>(uintptr_t(&buf[(n + i) * 2])) = __builtin_bswap16(uint16_t(p));
                             };
 
                             uint8_t sr = uint8_t(data[c + 0]);
@@ -615,11 +801,11 @@ __attribute__((hot, optimize("O3"), optimize("unroll-loops"))) void Strip::setUn
                         }
                         return;
                     }
-                    if (output_type == Model::StripConfig::HD108) {
-                        uint16_t *buf = reinterpret_cast<uint16_t *>(uintptr_t(&comp_buf[input_pad * uniN]));
+                    if (OUT == Model::StripConfig::HD108) {
+                        uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[start]);  // cppcheck-suppress constVariablePointer
                         for (size_t c = 0, n = 0; c < pixel_loop_n; c += 4, n += 3) {
                             auto write_buf = [=](const size_t i, const uint16_t p) {
-                                *reinterpret_cast<uint16_t *>(&buf[(n + i) * 2]) = __builtin_bswap16(uint16_t(p));
+                                *reinterpret_cast<uint16_t *>(uintptr_t(&buf[(n + i) * 2])) = __builtin_bswap16(uint16_t(p));
                             };
 
                             uint8_t sr = uint8_t(data[c + 0]);
@@ -651,11 +837,11 @@ __attribute__((hot, optimize("O3"), optimize("unroll-loops"))) void Strip::setUn
             }
         } break;
         case Model::StripConfig::RGB16_LSB: {
-            switch (nativeType()) {
+            switch (native) {
                 default: {
                 } break;
                 case Model::StripConfig::NATIVE_RGB8: {
-                    uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[input_pad * uniN]);  // cppcheck-suppress constVariablePointer
+                    uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[start]);  // cppcheck-suppress constVariablePointer
                     for (size_t c = 0, n = 0; c < pixel_loop_n; c += 6, n += order_size) {
                         for (size_t d = 0; d < pixel_pad; d++) {
                             buf[n + order[d]] = uint8_t(std::min(limit_8bit, uint32_t(data[c + d * 2 + 1])));
@@ -663,7 +849,7 @@ __attribute__((hot, optimize("O3"), optimize("unroll-loops"))) void Strip::setUn
                     }
                 } break;
                 case Model::StripConfig::NATIVE_RGBW8: {
-                    uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[input_pad * uniN]);  // cppcheck-suppress constVariablePointer
+                    uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[start]);  // cppcheck-suppress constVariablePointer
                     for (size_t c = 0, n = 0; c < pixel_loop_n; c += 6, n += 4) {
                         auto read_buf = [=](const size_t i) { return uint32_t(data[c + i * 2 + 1]); };
                         auto write_buf = [=](const size_t i, const uint8_t p) { buf[n + order[i]] = p; };
@@ -681,8 +867,8 @@ __attribute__((hot, optimize("O3"), optimize("unroll-loops"))) void Strip::setUn
                     }
                 } break;
                 case Model::StripConfig::NATIVE_RGB16: {
-                    if (output_type == Model::StripConfig::WS2816) {
-                        uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[input_pad * uniN]);  // cppcheck-suppress constVariablePointer
+                    if (OUT == Model::StripConfig::WS2816) {
+                        uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[start]);  // cppcheck-suppress constVariablePointer
                         for (size_t c = 0, n = 0; c < pixel_loop_n; c += 6, n += 3) {
                             auto read_buf = [=](const size_t i) { return uint32_t(*reinterpret_cast<const uint16_t *>(uintptr_t(&data[c + i * 2]))); };
                             auto write_buf = [=](const size_t i, const uint16_t p) {
@@ -695,8 +881,8 @@ __attribute__((hot, optimize("O3"), optimize("unroll-loops"))) void Strip::setUn
                         }
                         return;
                     }
-                    if (output_type == Model::StripConfig::HD108) {
-                        uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[input_pad * uniN]);  // cppcheck-suppress constVariablePointer
+                    if (OUT == Model::StripConfig::HD108) {
+                        uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[start]);  // cppcheck-suppress constVariablePointer
                         for (size_t c = 0, n = 0; c < pixel_loop_n; c += 6, n += 3) {
                             auto read_buf = [=](const size_t i) { return uint32_t(*reinterpret_cast<const uint16_t *>(uintptr_t(&data[c + i * 2]))); };
                             auto write_buf = [=](const size_t i, const uint16_t p) {
@@ -713,11 +899,11 @@ __attribute__((hot, optimize("O3"), optimize("unroll-loops"))) void Strip::setUn
             }
         } break;
         case Model::StripConfig::RGB16_MSB: {
-            switch (nativeType()) {
+            switch (native) {
                 default: {
                 } break;
                 case Model::StripConfig::NATIVE_RGB8: {
-                    uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[input_pad * uniN]);  // cppcheck-suppress constVariablePointer
+                    uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[start]);  // cppcheck-suppress constVariablePointer
                     for (size_t c = 0, n = 0; c < pixel_loop_n; c += 6, n += order_size) {
                         for (size_t d = 0; d < pixel_pad; d++) {
                             buf[n + order[d]] = uint8_t(std::min(limit_8bit, uint32_t(data[c + d * 2 + 0])));
@@ -725,7 +911,7 @@ __attribute__((hot, optimize("O3"), optimize("unroll-loops"))) void Strip::setUn
                     }
                 } break;
                 case Model::StripConfig::NATIVE_RGBW8: {
-                    uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[input_pad * uniN]);  // cppcheck-suppress constVariablePointer
+                    uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[start]);  // cppcheck-suppress constVariablePointer
                     for (size_t c = 0, n = 0; c < pixel_loop_n; c += 6, n += 4) {
                         auto read_buf = [=](const size_t i) { return uint32_t(data[c + i * 2]); };
                         auto write_buf = [=](const size_t i, const uint8_t p) { buf[n + order[i]] = p; };
@@ -743,8 +929,8 @@ __attribute__((hot, optimize("O3"), optimize("unroll-loops"))) void Strip::setUn
                     }
                 } break;
                 case Model::StripConfig::NATIVE_RGB16: {
-                    if (output_type == Model::StripConfig::WS2816) {
-                        uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[input_pad * uniN]);  // cppcheck-suppress constVariablePointer
+                    if (OUT == Model::StripConfig::WS2816) {
+                        uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[start]);  // cppcheck-suppress constVariablePointer
                         for (size_t c = 0, n = 0; c < pixel_loop_n; c += 6, n += 3) {
                             auto read_buf = [=](const size_t i) {
                                 return uint32_t(__builtin_bswap16(*reinterpret_cast<const uint16_t *>(uintptr_t(&data[c + i * 2]))));
@@ -759,8 +945,8 @@ __attribute__((hot, optimize("O3"), optimize("unroll-loops"))) void Strip::setUn
                         }
                         return;
                     }
-                    if (output_type == Model::StripConfig::HD108) {
-                        uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[input_pad * uniN]);  // cppcheck-suppress constVariablePointer
+                    if (OUT == Model::StripConfig::HD108) {
+                        uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[start]);  // cppcheck-suppress constVariablePointer
                         for (size_t c = 0, n = 0; c < pixel_loop_n; c += 6, n += 3) {
                             auto read_buf = [=](const size_t i) {
                                 return uint32_t(__builtin_bswap16(*reinterpret_cast<const uint16_t *>(uintptr_t(&data[c + i * 2]))));
@@ -779,11 +965,11 @@ __attribute__((hot, optimize("O3"), optimize("unroll-loops"))) void Strip::setUn
             }
         } break;
         case Model::StripConfig::RGBW16_LSB: {
-            switch (nativeType()) {
+            switch (native) {
                 default: {
                 } break;
                 case Model::StripConfig::NATIVE_RGB8: {
-                    uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[input_pad * uniN]);  // cppcheck-suppress constVariablePointer
+                    uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[start]);  // cppcheck-suppress constVariablePointer
                     for (size_t c = 0, n = 0; c < pixel_loop_n; c += 8, n += 3) {
                         auto read_buf = [=](const size_t i) { return uint32_t(*reinterpret_cast<const uint16_t *>(uintptr_t(&data[c + i * 2 + 1]))); };
                         auto write_buf = [=](const size_t i, const uint8_t p) { buf[n + order[i]] = p; };
@@ -799,7 +985,7 @@ __attribute__((hot, optimize("O3"), optimize("unroll-loops"))) void Strip::setUn
                     }
                 } break;
                 case Model::StripConfig::NATIVE_RGBW8: {
-                    uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[input_pad * uniN]);  // cppcheck-suppress constVariablePointer
+                    uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[start]);  // cppcheck-suppress constVariablePointer
                     for (size_t c = 0, n = 0; c < pixel_loop_n; c += 8, n += order_size) {
                         for (size_t d = 0; d < pixel_pad; d++) {
                             buf[n + order[d]] = uint8_t(std::min(limit_8bit, uint32_t(data[c + d * 2 + 1])));
@@ -807,8 +993,8 @@ __attribute__((hot, optimize("O3"), optimize("unroll-loops"))) void Strip::setUn
                     }
                 } break;
                 case Model::StripConfig::NATIVE_RGB16: {
-                    if (output_type == Model::StripConfig::WS2816) {
-                        uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[input_pad * uniN]);  // cppcheck-suppress constVariablePointer
+                    if (OUT == Model::StripConfig::WS2816) {
+                        uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[start]);  // cppcheck-suppress constVariablePointer
                         for (size_t c = 0, n = 0; c < pixel_loop_n; c += 8, n += 3) {
                             auto read_buf = [=](const size_t i) { return uint32_t(*reinterpret_cast<const uint16_t *>(uintptr_t(&data[c + i * 2]))); };
                             auto write_buf = [=](const size_t i, const uint16_t p) {
@@ -826,8 +1012,8 @@ __attribute__((hot, optimize("O3"), optimize("unroll-loops"))) void Strip::setUn
                         }
                         return;
                     }
-                    if (output_type == Model::StripConfig::HD108) {
-                        uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[input_pad * uniN]);  // cppcheck-suppress constVariablePointer
+                    if (OUT == Model::StripConfig::HD108) {
+                        uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[start]);  // cppcheck-suppress constVariablePointer
                         for (size_t c = 0, n = 0; c < pixel_loop_n; c += 8, n += 3) {
                             auto read_buf = [=](const size_t i) { return uint32_t(*reinterpret_cast<const uint16_t *>(uintptr_t(&data[c + i * 2]))); };
                             auto write_buf = [=](const size_t i, const uint16_t p) {
@@ -849,11 +1035,11 @@ __attribute__((hot, optimize("O3"), optimize("unroll-loops"))) void Strip::setUn
             }
         } break;
         case Model::StripConfig::RGBW16_MSB: {
-            switch (nativeType()) {
+            switch (native) {
                 default: {
                 } break;
                 case Model::StripConfig::NATIVE_RGB8: {
-                    uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[input_pad * uniN]);  // cppcheck-suppress constVariablePointer
+                    uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[start]);  // cppcheck-suppress constVariablePointer
                     for (size_t c = 0, n = 0; c < pixel_loop_n; c += 8, n += 3) {
                         auto read_buf = [=](const size_t i) { return uint32_t(*reinterpret_cast<const uint16_t *>(uintptr_t(&data[c + i * 2 + 0]))); };
 
@@ -868,7 +1054,7 @@ __attribute__((hot, optimize("O3"), optimize("unroll-loops"))) void Strip::setUn
                     }
                 } break;
                 case Model::StripConfig::NATIVE_RGBW8: {
-                    uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[input_pad * uniN]);  // cppcheck-suppress constVariablePointer
+                    uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[start]);  // cppcheck-suppress constVariablePointer
                     for (size_t c = 0, n = 0; c < pixel_loop_n; c += 8, n += order_size) {
                         for (size_t d = 0; d < pixel_pad; d++) {
                             buf[n + order[d]] = uint8_t(std::min(limit_8bit, uint32_t(data[c + d * 2 + 0])));
@@ -876,8 +1062,8 @@ __attribute__((hot, optimize("O3"), optimize("unroll-loops"))) void Strip::setUn
                     }
                 } break;
                 case Model::StripConfig::NATIVE_RGB16: {
-                    if (output_type == Model::StripConfig::WS2816) {
-                        uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[input_pad * uniN]);  // cppcheck-suppress constVariablePointer
+                    if (OUT == Model::StripConfig::WS2816) {
+                        uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[start]);  // cppcheck-suppress constVariablePointer
                         for (size_t c = 0, n = 0; c < pixel_loop_n; c += 8, n += 3) {
                             auto read_buf = [=](const size_t i) {
                                 return uint32_t(__builtin_bswap16(*reinterpret_cast<const uint16_t *>(uintptr_t(&data[c + i * 2]))));
@@ -901,8 +1087,8 @@ __attribute__((hot, optimize("O3"), optimize("unroll-loops"))) void Strip::setUn
                         }
                         return;
                     }
-                    if (output_type == Model::StripConfig::HD108) {
-                        uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[input_pad * uniN]);  // cppcheck-suppress constVariablePointer
+                    if (OUT == Model::StripConfig::HD108) {
+                        uint8_t *buf = reinterpret_cast<uint8_t *>(&comp_buf[start]);  // cppcheck-suppress constVariablePointer
                         for (size_t c = 0, n = 0; c < pixel_loop_n; c += 8, n += 3) {
                             auto read_buf = [=](const size_t i) {
                                 return uint32_t(__builtin_bswap16(*reinterpret_cast<const uint16_t *>(uintptr_t(&data[c + i * 2]))));
@@ -932,104 +1118,193 @@ __attribute__((hot, optimize("O3"), optimize("unroll-loops"))) void Strip::setUn
     }
 }
 
-void Strip::transfer() {
-    size_t len = 0;
-    if (Model::instance().burstMode && output_type != Model::StripConfig::TLS3001) {
-        const uint8_t *buf = prepareHead(len);
-        if (dmaTransferFunc) {
-            dmaTransferFunc((uint8_t *)(buf), uint16_t(len));
-        }
-        prepareTail();
-    } else {
-        const uint8_t *buf = prepare(len);
-        if (dmaTransferFunc) {
-            dmaTransferFunc((uint8_t *)(buf), uint16_t(len));
-        }
-    }
+template <Model::StripConfig::StripOutputType OUT, bool LIMITED, size_t... IN>
+constexpr std::array<Strip::UniverseKernel, sizeof...(IN)> Strip::universeKernels(std::index_sequence<IN...>) {
+    return {&Strip::setUniverseDataKernel<Model::StripConfig::StripInputType(IN), OUT, LIMITED>...};
+}
+
+template <Model::StripConfig::StripOutputType OUT>
+void Strip::useUniverseKernels(bool limited) {
+    constexpr auto inputs = std::make_index_sequence<inputTypeN>();
+    universe_kernels = limited ? universeKernels<OUT, true>(inputs) : universeKernels<OUT, false>(inputs);
 }
 
-const uint8_t *Strip::prepareHead(size_t &len) {
+void Strip::selectUniverseKernels() {
+    universe_hash_valid = 0;
+    // One kernel set per distinct native type/component order; output types sharing a layout share kernels
+    const bool limited = comp_limit < 1.0f;
     switch (output_type) {
-        case Model::StripConfig::TLS3001: {
-            return 0;
-        } break;
         default:
-        case Model::StripConfig::SK6812:
-        case Model::StripConfig::SK6812_RGBW:
         case Model::StripConfig::WS2812:
-        case Model::StripConfig::WS2816:
+        case Model::StripConfig::SK6812:
         case Model::StripConfig::TM1804:
         case Model::StripConfig::UCS1904:
-        case Model::StripConfig::TM1829:
-        case Model::StripConfig::GS8202: {
-            len = std::min(spi_buf.size(), (bytes_len + bytesLatchLen) * 4);
-            ws2812_alike_convert(0, std::min(bytes_len + bytesLatchLen, size_t(burstHeadLen)));
-            return spi_buf.data();
-        } break;
-        case Model::StripConfig::LPD8806: {
-            len = std::min(spi_buf.size(), (bytes_len + 1));
-            lpd8806_alike_convert(0, std::min(bytes_len + 1, size_t(burstHeadLen)));
-            return spi_buf.data();
-        } break;
-        case Model::StripConfig::WS2801: {
-            len = std::min(spi_buf.size(), bytes_len);
-            ws2801_alike_convert(0, std::min(bytes_len, size_t(burstHeadLen)));
-            return spi_buf.data();
-        } break;
-        case Model::StripConfig::HD108:
+        case Model::StripConfig::GS8202:
+        case Model::StripConfig::P9813:
         case Model::StripConfig::SK9822:
         case Model::StripConfig::HDS107S:
-        case Model::StripConfig::P9813:
+        case Model::StripConfig::LPD8806:
+        case Model::StripConfig::WS2801:
+        case Model::StripConfig::WS2811: {
+            useUniverseKernels<Model::StripConfig::WS2812>(limited);
+        } break;
+        case Model::StripConfig::APA102:
         case Model::StripConfig::APA107:
-        case Model::StripConfig::APA102: {
-            size_t out_len = bytes_len + bytes_len / 3;
-            size_t ext_len = 32 + ((bytes_len / 2) + 7) / 8;
-            len = std::min(spi_buf.size(), (out_len + ext_len));
-            apa102_alike_convert(0, std::min(out_len + ext_len, size_t(burstHeadLen)));
-            return spi_buf.data();
+        case Model::StripConfig::TM1829: {
+            useUniverseKernels<Model::StripConfig::APA102>(limited);
         } break;
-    }
-}
-
-void Strip::prepareTail() {
-    switch (output_type) {
         case Model::StripConfig::TLS3001: {
+            useUniverseKernels<Model::StripConfig::TLS3001>(limited);
         } break;
-        default:
-        case Model::StripConfig::SK6812:
-        case Model::StripConfig::SK6812_RGBW:
-        case Model::StripConfig::WS2812:
-        case Model::StripConfig::WS2816:
-        case Model::StripConfig::TM1804:
-        case Model::StripConfig::UCS1904:
-        case Model::StripConfig::TM1829:
-        case Model::StripConfig::GS8202: {
-            ws2812_alike_convert(std::min(bytes_len + bytesLatchLen, size_t(burstHeadLen)), bytes_len + bytesLatchLen);
+        case Model::StripConfig::SK6812_RGBW: {
+            useUniverseKernels<Model::StripConfig::SK6812_RGBW>(limited);
         } break;
-        case Model::StripConfig::LPD8806: {
-            lpd8806_alike_convert(std::min(bytes_len + 1, size_t(burstHeadLen)), (bytes_len + 1) - 1);
-        } break;
-        case Model::StripConfig::WS2801: {
-            ws2801_alike_convert(std::min(bytes_len, size_t(burstHeadLen)), bytes_len - 1);
+        case Model::StripConfig::HD108: {
+            useUniverseKernels<Model::StripConfig::HD108>(limited);
         } break;
-        case Model::StripConfig::HD108:
-        case Model::StripConfig::SK9822:
-        case Model::StripConfig::HDS107S:
-        case Model::StripConfig::P9813:
-        case Model::StripConfig::APA107:
-        case Model::StripConfig::APA102: {
-            size_t out_len = bytes_len + bytes_len / 3;
-            size_t ext_len = 32 + ((bytes_len / 2) + 7) / 8;
-            apa102_alike_convert(std::min(out_len + ext_len, size_t(burstHeadLen)), (out_len + ext_len) - 1);
+        case Model::StripConfig::WS2816: {
+            useUniverseKernels<Model::StripConfig::WS2816>(limited);
         } break;
     }
 }
 
-const uint8_t *Strip::prepare(size_t &len) {
+void Strip::transfer() {
+    publishFrame();
+    streamStart();
+}
+
+void Strip::streamStart() {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (streaming) {
+        // Picked up from streamStopped() once the current frame is out
+        __set_PRIMASK(primask);
+        return;
+    }
+    streaming = true;
+    __set_PRIMASK(primask);
+    streamBegin();
+}
+
+void Strip::streamBegin() {
+    if (ready_slot.load() & slotFresh) {
+        encode_slot = ready_slot.exchange(encode_slot) & slotMask;
+        frame_buf = frame_slots[encode_slot].data();
+    }
+
+    stream_pos = 0;
+    stream_len = streamLen();
+    stream_stopping = false;
+
+    tls3001_state = {};
+    tls3001_state.reset_frame = !strip_reset;
+    strip_reset = true;
+
+    stream_padding[0] = streamFill(&stream_buf[0], streamChunkLen) == 0;
+    stream_padding[1] = streamFill(&stream_buf[streamChunkLen], streamChunkLen) == 0;
+
+    if (!dmaTransferFunc) {
+        streaming = false;
+        return;
+    }
+    dmaTransferFunc(stream_buf.data(), stream_buf.size());
+}
+
+void Strip::streamHalfSent(size_t half) {
+    if (stream_stopping) {
+        return;
+    }
+    if (stream_padding[half]) {
+        // A full half of padding went out after the last data, so the SPI FIFO has drained too
+        stream_stopping = true;
+        if (dmaStopFunc) {
+            dmaStopFunc();
+        }
+        return;
+    }
+    stream_padding[half] = streamFill(&stream_buf[half * streamChunkLen], streamChunkLen) == 0;
+}
+
+void Strip::streamStopped() {
+    if (ready_slot.load() & slotFresh) {
+        streamBegin();
+        return;
+    }
+    streaming = false;
+}
+
+bool Strip::frameUniverseArrived(const size_t uniN, const uint8_t sequence, const Model::StripConfig::StripInputType input_type) {
+    if (frame_deadline_ms == 0) {
+        return true;
+    }
+
+    const uint32_t bit = 1UL << uniN;
+    if ((frame_arrived & bit) != 0) {
+        // Duplicate; frameUniverseStartsNext() already closed the frame for anything else
+        return false;
+    }
+
+    if (frame_arrived == 0) {
+        frame_start = Systick::instance().systemTimeRAW();
+    }
+    frame_arrived |= bit;
+    frame_sequence[uniN] = sequence;
+
+    uint32_t expected = 0;
+    for (size_t c = 0; c < Model::universeN; c++) {
+        if (isUniverseActive(c, input_type)) {
+            expected |= 1UL << c;
+        }
+    }
+
+    if ((frame_arrived & expected) == expected) {
+        frames_complete++;
+        frame_arrived = 0;
+        return true;
+    }
+    return false;
+}
+
+bool Strip::frameUniverseStartsNext(const size_t uniN, const uint8_t sequence) {
+    const uint32_t bit = 1UL << uniN;
+    if (frame_deadline_ms == 0 || (frame_arrived & bit) == 0) {
+        return false;
+    }
+    // A sequence of 0 means the sender does not sequence, so we can't tell duplicates apart
+    if (sequence != 0 && frame_sequence[uniN] == sequence) {
+        return false;
+    }
+    // Universe of the next frame arrived before the current one completed
+    frames_timed_out++;
+    frame_arrived = 0;
+    return true;
+}
+
+bool Strip::frameDeadlineExpired() {
+    if (frame_arrived == 0) {
+        return false;
+    }
+    const uint64_t deadline = Systick::msToCycles(frame_deadline_ms);
+    if (!Systick::elapsed(Systick::instance().systemTimeRAW(), frame_start, deadline)) {
+        return false;
+    }
+    frames_timed_out++;
+    frame_arrived = 0;
+    return true;
+}
+
+uint64_t Strip::frameDeadlineDue() const {
+    if (frame_arrived == 0) {
+        return UINT64_MAX;
+    }
+    return frame_start + Systick::msToCycles(frame_deadline_ms);
+}
+
+size_t Strip::streamLen() const {
     switch (output_type) {
         case Model::StripConfig::TLS3001: {
-            tls3001_alike_convert(len);
-            return spi_buf.data();
+            // Generated until the frame program runs out
+            return 0;
         } break;
         default:
         case Model::StripConfig::SK6812:
@@ -1040,19 +1315,11 @@ const uint8_t *Strip::prepare(size_t &len) {
         case Model::StripConfig::UCS1904:
         case Model::StripConfig::TM1829:
         case Model::StripConfig::GS8202: {
-            len = std::min(spi_buf.size(), (bytes_len + bytesLatchLen) * 4);
-            ws2812_alike_convert(0, bytes_len + bytesLatchLen);
-            return spi_buf.data();
-        } break;
-        case Model::StripConfig::LPD8806: {
-            len = std::min(spi_buf.size(), (bytes_len + 3));
-            lpd8806_alike_convert(0, (bytes_len + 3) - 1);
-            return spi_buf.data();
+            return (bytes_len + bytesLatchLen) * (nrz3Bit() ? 3 : 4);
         } break;
+        case Model::StripConfig::LPD8806:
         case Model::StripConfig::WS2801: {
-            len = std::min(spi_buf.size(), (bytes_len + 3));
-            ws2801_alike_convert(0, (bytes_len + 3));
-            return spi_buf.data();
+            return bytes_len + 3;
         } break;
         case Model::StripConfig::HD108:
         case Model::StripConfig::SK9822:
@@ -1062,154 +1329,315 @@ const uint8_t *Strip::prepare(size_t &len) {
         case Model::StripConfig::APA102: {
             size_t out_len = bytes_len + bytes_len / 3;
             size_t ext_len = 32 + ((out_len / 2) + 7) / 8;
-            len = std::min(spi_buf.size(), (out_len + ext_len));
-            apa102_alike_convert(0, (out_len + ext_len) - 1);
-            return spi_buf.data();
+            return out_len + ext_len;
         } break;
     }
 }
 
-__attribute__((hot, flatten, optimize("O3"))) void Strip::lpd8806_alike_convert(size_t start, size_t end) {
-    uint8_t *dst = spi_buf.data() + start;
-    *dst++ = 0x00;
+uint32_t Strip::wireTimeUs() const {
+    if (transfer_mbps == 0) {
+        return 0;
+    }
+    return uint32_t(uint64_t(streamLen()) * 8 * 1000000 / transfer_mbps);
+}
+
+size_t Strip::streamFill(uint8_t *dst, size_t len) {
+    size_t n = 0;
+    if (output_type == Model::StripConfig::TLS3001) {
+        n = tls3001_alike_convert(dst, len);
+    } else {
+        n = std::min(len, stream_len - stream_pos);
+        if (n > 0) {
+            switch (output_type) {
+                default:
+                case Model::StripConfig::SK6812:
+                case Model::StripConfig::SK6812_RGBW:
+                case Model::StripConfig::WS2812:
+                case Model::StripConfig::WS2816:
+                case Model::StripConfig::TM1804:
+                case Model::StripConfig::UCS1904:
+                case Model::StripConfig::TM1829:
+                case Model::StripConfig::GS8202: {
+                    if (nrz3Bit()) {
+                        ws2812_alike_convert3(dst, stream_pos, stream_pos + n);
+                    } else {
+                        ws2812_alike_convert(dst, stream_pos, stream_pos + n);
+                    }
+                } break;
+                case Model::StripConfig::LPD8806: {
+                    lpd8806_alike_convert(dst, stream_pos, stream_pos + n);
+                } break;
+                case Model::StripConfig::WS2801: {
+                    ws2801_alike_convert(dst, stream_pos, stream_pos + n);
+                } break;
+                case Model::StripConfig::HD108:
+                case Model::StripConfig::SK9822:
+                case Model::StripConfig::HDS107S:
+                case Model::StripConfig::P9813:
+                case Model::StripConfig::APA107:
+                case Model::StripConfig::APA102: {
+                    apa102_alike_convert(dst, stream_pos, stream_pos + n);
+                } break;
+            }
+        }
+        stream_pos += n;
+    }
+    // Idle line after the frame; doubles as latch/end frame
+    memset(dst + n, 0, len - n);
+    return n;
+}
+
+__attribute__((hot, flatten, optimize("O3"))) void Strip::lpd8806_alike_convert(uint8_t *dst, size_t start, size_t end) {
     switch (nativeType()) {
         default: {
+            memset(dst, 0, end - start);
         } break;
         case Model::StripConfig::NATIVE_RGBW8:
         case Model::StripConfig::NATIVE_RGB8: {
-            for (size_t c = std::max(start, size_t(1)); c <= std::min(end, 1 + bytes_len - 1); c++) {
-                *dst++ = 0x80 | (comp_buf[c - 1] >> 1);
+            for (size_t c = start; c < end; c++) {
+                *dst++ = (c >= 1 && c <= bytes_len) ? uint8_t(0x80 | (frame_buf[c - 1] >> 1)) : 0x00;
             }
         } break;
     }
 }
 
-__attribute__((hot, flatten, optimize("O3"))) void Strip::ws2801_alike_convert(size_t start, size_t end) {
-    uint8_t *dst = spi_buf.data() + start;
+__attribute__((hot, flatten, optimize("O3"))) void Strip::ws2801_alike_convert(uint8_t *dst, size_t start, size_t end) {
     switch (nativeType()) {
         default: {
+            memset(dst, 0, end - start);
         } break;
         case Model::StripConfig::NATIVE_RGBW8:
         case Model::StripConfig::NATIVE_RGB8: {
-            for (size_t c = start; c <= std::min(end, bytes_len - 1); c++) {
-                *dst++ = comp_buf[c];
+            for (size_t c = start; c < end; c++) {
+                *dst++ = (c < bytes_len) ? frame_buf[c] : 0x00;
             }
         } break;
     }
 }
 
-__attribute__((hot, flatten, optimize("O3"), optimize("unroll-loops"))) void Strip::apa102_alike_convert(size_t start, size_t end) {
-    // Align to 4 bytes
-    start &= ~3UL;
-
-    uint8_t *dst = spi_buf.data() + start;
-    size_t out_len = bytes_len + (bytes_len / 3);
+__attribute__((hot, flatten, optimize("O3"), optimize("unroll-loops"))) void Strip::apa102_alike_convert(uint8_t *dst, size_t start, size_t end) {
+    const size_t out_len = bytes_len + (bytes_len / 3);
 
     // start frame
-    size_t head_len = 32;
-    for (size_t c = start; c <= std::min(end, size_t(head_len - 1)); c++) {
+    const size_t head_len = 32;
+    size_t c = start;
+    for (; c < std::min(end, head_len); c++) {
         *dst++ = 0x00;
     }
 
-    size_t offset = 0;
-    // adjust offset
-    for (size_t c = head_len; c < start; c += 4, offset += 3) {
+    const size_t loop_end = std::min(end, head_len + out_len);
+    if (c < loop_end) {
+        switch (nativeType()) {
+            default: {
+            } break;
+            case Model::StripConfig::NATIVE_RGB16: {
+                uint8_t illum5 = uint8_t(float(0x1f) * std::clamp(glob_illum, 0.0f, 1.0f));
+                uint16_t illum16 = 0b1000'0000'0000'0000 | (illum5 << 10) | (illum5 << 5) | illum5;
+                const uint8_t illum[2] = {uint8_t(illum16 >> 8), uint8_t(illum16 & 0xFF)};
+                size_t k = (c - head_len) % 8;
+                const uint8_t *src = &frame_buf[((c - head_len) / 8) * 6];
+                for (; c < loop_end; c++) {
+                    *dst++ = (k < 2) ? illum[k] : src[k - 2];
+                    if (++k == 8) {
+                        k = 0;
+                        src += 6;
+                    }
+                }
+            } break;
+            case Model::StripConfig::NATIVE_RGB8: {
+                uint8_t illum = 0b11100000 | uint8_t(float(0x1f) * std::clamp(glob_illum, 0.0f, 1.0f));
+                size_t k = (c - head_len) % 4;
+                const uint8_t *src = &frame_buf[((c - head_len) / 4) * 3];
+                for (; c < loop_end; c++) {
+                    *dst++ = (k < 1) ? illum : src[k - 1];
+                    if (++k == 4) {
+                        k = 0;
+                        src += 3;
+                    }
+                }
+            } break;
+        }
     }
 
-    size_t loop_start = std::max(start, size_t(head_len));
-    size_t loop_end = std::min(end, head_len + out_len - 1);
+    // end frame
+    for (; c < end; c++) {
+        *dst++ = 0x00;
+    }
+}
+
+__attribute__((hot, flatten, optimize("O3"), optimize("unroll-loops"))) void Strip::ws2812_alike_convert(uint8_t *dst, const size_t start, const size_t end) {
+    // One 32-bit word per component byte; start and end are always word aligned
+    uint32_t *out = reinterpret_cast<uint32_t *>(uintptr_t(dst));
+    const size_t head_len = bytesLatchLen / 2;
+    const size_t word_end = end / 4;
+    size_t c = start / 4;
+    for (; c < std::min(word_end, head_len); c++) {
+        *out++ = 0x00;
+    }
 
     switch (nativeType()) {
         default: {
         } break;
-        case Model::StripConfig::NATIVE_RGB16: {
-            uint8_t illum5 = uint8_t(float(0x1f) * std::clamp(glob_illum, 0.0f, 1.0f));
-            uint16_t illum16 = 0b1000'0000'0000'0000 | (illum5 << 10) | (illum5 << 5) | illum5;
-            for (size_t c = loop_start; c <= loop_end; c += 4, offset += 6) {
-                *dst++ = uint8_t(illum16 >> 8);
-                *dst++ = uint8_t(illum16 & 0xFF);
-                *dst++ = comp_buf[offset + 0];
-                *dst++ = comp_buf[offset + 1];
-                *dst++ = comp_buf[offset + 2];
-                *dst++ = comp_buf[offset + 3];
-                *dst++ = comp_buf[offset + 4];
-                *dst++ = comp_buf[offset + 5];
-            }
-        } break;
+        case Model::StripConfig::NATIVE_RGB16:
+        case Model::StripConfig::NATIVE_RGBW8:
         case Model::StripConfig::NATIVE_RGB8: {
-            uint8_t illum = 0b11100000 | uint8_t(float(0x1f) * std::clamp(glob_illum, 0.0f, 1.0f));
-            for (size_t c = loop_start; c <= loop_end; c += 4, offset += 3) {
-                *dst++ = illum;
-                *dst++ = comp_buf[offset + 0];
-                *dst++ = comp_buf[offset + 1];
-                *dst++ = comp_buf[offset + 2];
+            const size_t loop_end = std::min(word_end, head_len + bytes_len);
+            if (c < loop_end) {
+                const uint8_t *src = &frame_buf[c - head_len];
+                for (; c + 4 <= loop_end; c += 4) {
+                    uint32_t s = 0;
+                    memcpy(&s, src, sizeof(s));
+                    auto w = ws2812_encode4(s);
+                    out[0] = w[0];
+                    out[1] = w[1];
+                    out[2] = w[2];
+                    out[3] = w[3];
+                    out += 4;
+                    src += 4;
+                }
+                for (; c < loop_end; c++) {
+                    *out++ = ws2812_encode(*src++);
+                }
             }
         } break;
     }
-    // latch words
-    for (size_t c = std::max(start, head_len + out_len); c <= end; c++) {
-        *dst++ = 0x00;
-        *dst++ = 0x00;
-        *dst++ = 0x00;
-        *dst++ = 0x00;
-    }
-}
 
-__attribute__((hot, flatten, optimize("O3"), optimize("unroll-loops"))) void Strip::ws2812_alike_convert(const size_t start, const size_t end) {
-    uint32_t *dst = reinterpret_cast<uint32_t *>(uintptr_t(spi_buf.data() + start * 4));
-    size_t head_len = bytesLatchLen / 2;
-    for (size_t c = start; c < std::min(end, size_t(head_len)); c++) {
-        *dst++ = 0x00;
+    for (; c < word_end; c++) {
+        *out++ = 0x00;
     }
+}
 
+__attribute__((hot, flatten, optimize("O3"), optimize("unroll-loops"))) void Strip::ws2812_alike_convert3(uint8_t *dst, const size_t start, const size_t end) {
+    // Three bytes per component byte; chunks are not a multiple of three so either end may split a component
+    const size_t head_len = bytesLatchLen / 2;
+    size_t data_len = 0;
     switch (nativeType()) {
         default: {
         } break;
         case Model::StripConfig::NATIVE_RGB16:
         case Model::StripConfig::NATIVE_RGBW8:
         case Model::StripConfig::NATIVE_RGB8: {
-            const uint8_t *src = &comp_buf[std::max(start, size_t(head_len)) - head_len];
-            const int32_t len = int32_t(std::min(end, head_len + bytes_len)) - int32_t(std::max(start, size_t(head_len)));
-            for (int32_t c = 0; c <= len; c++) {
-                dst[c] = ws2812_lut[src[c]];
-            }
-            dst += len;
+            data_len = bytes_len;
         } break;
     }
-    for (size_t c = std::max(start, head_len + bytes_len); c <= end; c++) {
-        *dst++ = 0x00;
+    auto component = [this, head_len, data_len](size_t i) {
+        if (i < head_len || i >= head_len + data_len) {
+            return uint32_t(0);
+        }
+        return ws2812_encode3(frame_buf[i - head_len]);
+    };
+
+    size_t c = start;
+    for (; c < end && (c % 3) != 0; c++) {
+        *dst++ = uint8_t(component(c / 3) >> (8 * (2 - (c % 3))));
+    }
+    for (; c + 3 <= end; c += 3) {
+        uint32_t v = component(c / 3);
+        *dst++ = uint8_t(v >> 16);
+        *dst++ = uint8_t(v >> 8);
+        *dst++ = uint8_t(v);
+    }
+    for (; c < end; c++) {
+        *dst++ = uint8_t(component(c / 3) >> (8 * (2 - (c % 3))));
     }
 }
 
-__attribute__((hot, flatten, optimize("O3"), optimize("unroll-loops"))) void Strip::tls3001_alike_convert(size_t &len) {
-    uint8_t *dst = spi_buf.data();
-    manchester_bit_buf buf(dst);
-    if (!strip_reset) {
-        uint32_t reset = 0b11111111'11111110'10000000'00000000;  // 19 bits
-        uint32_t syncw = 0b11111111'11111110'00100000'00000000;  // 30 bits
-        strip_reset = true;
-        buf.push(reset, 19);
-        buf.push(0, 4000);
-        buf.push(syncw, 30);
-        buf.push(0, 12 * int32_t(bytes_len / 3));
-    } else {
-        uint32_t start = 0b11111111'11111110'01000000'00000000;  // 19 bits
-        buf.push(start, 19);
-        switch (nativeType()) {
-            default: {
-            } break;
-            case Model::StripConfig::NATIVE_RGBW8:
-            case Model::StripConfig::NATIVE_RGB8: {
-                for (size_t c = 0; c < bytes_len; c++) {
-                    uint32_t p = uint32_t(comp_buf[c]);
-                    buf.push((p << 19) | (p << 11), 13);
+__attribute__((hot, flatten, optimize("O3"), optimize("unroll-loops"))) size_t Strip::tls3001_alike_convert(uint8_t *dst, size_t len) {
+    TLS3001State &st = tls3001_state;
+    size_t n = 0;
+    while (n < len) {
+        if (st.acc_bits >= 8) {
+            st.acc_bits -= 8;
+            dst[n++] = uint8_t(st.acc >> st.acc_bits);
+            continue;
+        }
+        if (st.seg_count <= 0) {
+            if (!tls3001_segment(st.seg_bits, st.seg_count)) {
+                if (st.acc_bits > 0) {
+                    dst[n++] = uint8_t(st.acc << (8 - st.acc_bits));
+                    st.acc_bits = 0;
                 }
-            } break;
+                break;
+            }
+            continue;
         }
-        buf.push(0, 100);
-        buf.push(start, 19);
+        if (st.seg_bits == 0 && st.seg_count >= 8) {
+            // Run of zeros: top up the pending byte, then whole 0x55 bytes (4 bits each)
+            dst[n++] = uint8_t((st.acc << (8 - st.acc_bits)) | (0x55U >> st.acc_bits));
+            st.seg_count -= (8 - st.acc_bits) / 2;
+            st.acc_bits = 0;
+            size_t run = std::min(len - n, size_t(st.seg_count / 4));
+            memset(&dst[n], 0x55, run);
+            n += run;
+            st.seg_count -= int32_t(run * 4);
+            continue;
+        }
+        const int32_t count = std::min(st.seg_count, int32_t(16));
+        const uint32_t bits = st.seg_bits;
+        st.seg_bits <<= count;
+        st.seg_count -= count;
+        const uint32_t m = (uint32_t(manchester_lut[bits >> 24]) << 16) | manchester_lut[(bits >> 16) & 0xFF];
+        st.acc = (st.acc << (count * 2)) | (m >> (32 - count * 2));
+        st.acc_bits += count * 2;
     }
-    buf.flush();
+    return n;
+}
 
-    len = buf.len();
+bool Strip::tls3001_segment(uint32_t &bits, int32_t &count) {
+    static constexpr uint32_t reset = 0b11111111'11111110'10000000'00000000;  // 19 bits
+    static constexpr uint32_t syncw = 0b11111111'11111110'00100000'00000000;  // 30 bits
+    static constexpr uint32_t start = 0b11111111'11111110'01000000'00000000;  // 19 bits
+    TLS3001State &st = tls3001_state;
+    if (st.reset_frame) {
+        switch (st.phase++) {
+            case 0: {
+                bits = reset;
+                count = 19;
+            } break;
+            case 1: {
+                bits = 0;
+                count = 4000;
+            } break;
+            case 2: {
+                bits = syncw;
+                count = 30;
+            } break;
+            case 3: {
+                bits = 0;
+                count = 12 * int32_t(bytes_len / 3);
+            } break;
+            default: {
+                return false;
+            } break;
+        }
+        return true;
+    }
+    switch (st.phase) {
+        case 0: {
+            st.phase++;
+            bits = start;
+            count = 19;
+        } break;
+        case 1: {
+            if (st.index < bytes_len &&
+                (nativeType() == Model::StripConfig::NATIVE_RGB8 || nativeType() == Model::StripConfig::NATIVE_RGBW8)) {
+                uint32_t p = uint32_t(frame_buf[st.index++]);
+                bits = (p << 19) | (p << 11);
+                count = 13;
+                break;
+            }
+            st.phase++;
+            bits = 0;
+            count = 100;
+        } break;
+        case 2: {
+            st.phase++;
+            bits = start;
+            count = 19;
+        } break;
+        default: {
+            return false;
+        } break;
+    }
+    return true;
 }
@@ -27,7 +27,9 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <string.h>
 
 #include <array>
+#include <atomic>
 #include <functional>
+#include <utility>
 
 #include "./model.h"
 
@@ -41,36 +43,63 @@ class Strip {
     static constexpr size_t dmxMaxLen = 512;
     static constexpr size_t bytesMaxLen = (dmxMaxLen * Model::universeN);
     static constexpr size_t bytesLatchLen = 64;
-    static constexpr size_t spiMaxLen = (bytesMaxLen * sizeof(uint32_t) + bytesLatchLen * sizeof(uint32_t));
-    static constexpr size_t burstHeadLen = 128;
+    static constexpr size_t streamChunkLen = 512;
+    static constexpr size_t streamBufLen = streamChunkLen * 2;
 
     static Strip &get(size_t index);
 
     bool needsClock() const;
+    bool nrz3Bit() const;
 
-    void setStripType(Model::StripConfig::StripOutputType type) { output_type = type; }
+    void setStripType(Model::StripConfig::StripOutputType type) {
+        output_type = type;
+        selectUniverseKernels();
+    }
     void setStartupMode(Model::StripConfig::StripStartupMode type) { startup_mode = type; }
     void setRGBColorSpace(const RGBColorSpace &colorSpace);
-    void setCompLimit(float value) { comp_limit = value; };
+    void setCompLimit(float value) {
+        comp_limit = value;
+        selectUniverseKernels();
+    };
     void setGlobIllum(float value) { glob_illum = value; };
     void setTransferMbps(uint32_t mbps) { transfer_mbps = mbps; };
+    void setNrzBits(uint8_t bits) { nrz_bits = bits; };
 
     void setPixelLen(size_t len);
     size_t getPixelLen() const;
     size_t getMaxPixelLen() const;
     size_t getBytesPerPixel() const;
     uint32_t transferMpbs() const { return transfer_mbps; };
+    uint32_t wireTimeUs() const;
 
     Model::StripConfig::StripNativeType nativeType() const;
 
     void setUniverseData(const size_t N, const uint8_t *data, const size_t len, const Model::StripConfig::StripInputType input_type);
     void setData(const uint8_t *data, const size_t len, const Model::StripConfig::StripInputType input_type);
+    void setPixelData(const size_t offset, const uint8_t *data, const size_t len, const Model::StripConfig::StripInputType input_type);
+    size_t getInputLen(Model::StripConfig::StripInputType input_type) const { return getPixelLen() * getBytesPerInputPixel(input_type); }
     bool isUniverseActive(size_t uniN, Model::StripConfig::StripInputType input_type) const;
 
     void transfer();
+    void queueFrame(uint64_t due);
+    uint64_t presentDue(uint64_t now);
+    uint32_t lateFrames() const { return late_frames; }
+    uint32_t earlyFrames() const { return early_frames; }
+    void streamHalfSent(size_t half);
+    void streamStopped();
+    uint32_t overwrittenFrames() const { return overwritten_frames; }
+    uint32_t unchangedUniverses() const { return unchanged_universes; }
+
+    void setFrameDeadline(uint32_t ms) { frame_deadline_ms = ms; }
+    bool frameUniverseStartsNext(const size_t uniN, const uint8_t sequence);
+    bool frameUniverseArrived(const size_t uniN, const uint8_t sequence, const Model::StripConfig::StripInputType input_type);
+    bool frameDeadlineExpired();
+    uint64_t frameDeadlineDue() const;
+    uint32_t framesComplete() const { return frames_complete; }
+    uint32_t framesTimedOut() const { return frames_timed_out; }
 
     std::function<void(const uint8_t *data, size_t len)> dmaTransferFunc{};
-    std::function<bool()> dmaBusyFunc{};
+    std::function<void()> dmaStopFunc{};
 
     void setPendingTransferFlag() { transfer_flag = true; }
     bool pendingTransferFlag() {
@@ -82,25 +111,46 @@ class Strip {
     }
 
    private:
+    // Host benchmarks in bench/ drive the encoders and kernels directly
+    friend class StripBench;
+
     bool use32Bit();
 
     void init();
 
     void setBytesLen(size_t len);
+    void markDirty(size_t start, size_t end);
+    void publishFrame();
+    uint8_t publishSlot(uint8_t slot);
+    void catchUpWriteSlot(uint8_t from);
+    void presentNext();
     size_t getMaxBytesLen() const;
     size_t getBytesPerInputPixel(Model::StripConfig::StripInputType input_type) const;
     size_t getComponentsPerInputPixel(Model::StripConfig::StripInputType input_type) const;
     size_t getComponentBytes(Model::StripConfig::StripInputType input_type) const;
 
-    const uint8_t *prepareHead(size_t &len);
-    void prepareTail();
-    const uint8_t *prepare(size_t &len);
-
-    void lpd8806_alike_convert(size_t start, size_t end);
-    void ws2801_alike_convert(size_t start, size_t end);
-    void apa102_alike_convert(size_t start, size_t end);
-    void ws2812_alike_convert(const size_t start, const size_t end);
-    void tls3001_alike_convert(size_t &len);
+    static constexpr size_t inputTypeN = magic_enum::enum_count<Model::StripConfig::StripInputType>();
+    using UniverseKernel = void (Strip::*)(const size_t start, const uint8_t *data, const size_t len);
+    template <Model::StripConfig::StripInputType IN, Model::StripConfig::StripOutputType OUT, bool LIMITED>
+    void setUniverseDataKernel(const size_t start, const uint8_t *data, const size_t len);
+    template <Model::StripConfig::StripOutputType OUT, bool LIMITED, size_t... IN>
+    static constexpr std::array<UniverseKernel, sizeof...(IN)> universeKernels(std::index_sequence<IN...>);
+    template <Model::StripConfig::StripOutputType OUT>
+    void useUniverseKernels(bool limited);
+    void selectUniverseKernels();
+
+    void streamStart();
+    void streamBegin();
+    size_t streamLen() const;
+    size_t streamFill(uint8_t *dst, size_t len);
+
+    void lpd8806_alike_convert(uint8_t *dst, size_t start, size_t end);
+    void ws2801_alike_convert(uint8_t *dst, size_t start, size_t end);
+    void apa102_alike_convert(uint8_t *dst, size_t start, size_t end);
+    void ws2812_alike_convert(uint8_t *dst, const size_t start, const size_t end);
+    void ws2812_alike_convert3(uint8_t *dst, const size_t start, const size_t end);
+    size_t tls3001_alike_convert(uint8_t *dst, size_t len);
+    bool tls3001_segment(uint32_t &bits, int32_t &count);
 
     Model::StripConfig::StripStartupMode startup_mode = Model::StripConfig::COLOR;
     Model::StripConfig::StripOutputType output_type = Model::StripConfig::StripOutputType::WS2812;
@@ -110,15 +160,72 @@ class Strip {
     float comp_limit = 1.0f;
     float glob_illum = 1.0f;
     uint32_t transfer_mbps = 900000 * 4;
+    uint8_t nrz_bits = 4;
+    std::array<UniverseKernel, inputTypeN> universe_kernels{};
+
+    static_assert(Model::universeN <= 32);
+    uint32_t frame_deadline_ms = 0;
+    uint32_t frame_arrived = 0;
+    uint64_t frame_start = 0;
+    uint32_t frames_complete = 0;
+    uint32_t frames_timed_out = 0;
+    std::array<uint8_t, Model::universeN> frame_sequence{};
 
-    static bool ws2812_lut_init;
-    static std::array<uint32_t, 256> ws2812_lut;
     static bool hd108_lut_init;
     static std::array<std::array<uint16_t, 256>, 3> hd108_lut;
 
-    std::array<uint8_t, bytesMaxLen> comp_buf{};
-    std::array<uint8_t, spiMaxLen> spi_buf{};
+    // Triple buffer: universes are written into the write slot, transfer() publishes it as ready and the
+    // encoder swaps the ready slot in at frame start. Neither side waits on the other. A frame with a
+    // presentation time parks its slot in frame_queue until due. There is one spare slot, so a second
+    // timed frame pushes the queued one out early.
+    static constexpr size_t queueN = 1;
+    static constexpr size_t slotN = 3 + queueN;
+    static constexpr uint8_t slotMask = 0x07;
+    static constexpr uint8_t slotFresh = 0x80;
+    static_assert(slotN <= slotMask + 1);
+    struct Span {
+        size_t start = bytesMaxLen;
+        size_t end = 0;
+    };
+    std::array<std::array<uint8_t, bytesMaxLen>, slotN> frame_slots{};
+    std::array<Span, slotN> slot_stale{};
+    uint8_t write_slot = 0;
+    uint8_t encode_slot = 1;
+    std::atomic<uint8_t> ready_slot = 2;
+    uint32_t overwritten_frames = 0;
+    struct QueuedFrame {
+        uint8_t slot;
+        uint64_t due;
+    };
+    std::array<QueuedFrame, queueN> frame_queue{};
+    size_t queue_head = 0;
+    size_t queue_count = 0;
+    uint8_t free_slots = 0;
+    uint32_t late_frames = 0;
+    uint32_t early_frames = 0;
+    uint8_t *comp_buf = frame_slots[0].data();
+    const uint8_t *frame_buf = frame_slots[1].data();
     size_t bytes_len = 0;
+
+    std::array<uint32_t, Model::universeN> universe_hash{};
+    uint32_t universe_hash_valid = 0;
+    uint32_t unchanged_universes = 0;
+    alignas(uint32_t) std::array<uint8_t, streamBufLen> stream_buf{};
+    size_t stream_pos = 0;
+    size_t stream_len = 0;
+    bool stream_padding[2]{};
+    bool stream_stopping = false;
+    volatile bool streaming = false;
+
+    struct TLS3001State {
+        bool reset_frame;
+        uint32_t phase;
+        size_t index;
+        uint32_t seg_bits;
+        int32_t seg_count;
+        uint64_t acc;
+        int32_t acc_bits;
+    } tls3001_state{};
 };
 
 #endif /* STRIP_H_ */
@@ -136,9 +136,7 @@
 
 /* This define specifies the maximum number of multicast groups that can be joined.
    The default value is 7.  */
-/*
-#define NX_MAX_MULTICAST_GROUPS     7
-*/
+#define NX_MAX_MULTICAST_GROUPS     48
 
 
 /* Configuration options for IPv6 */
@@ -499,16 +497,15 @@
 */
 
 /* Defined, feature of low watermark is enabled. */
-/*
 #define NX_ENABLE_LOW_WATERMARK
-*/
 
-/* Define the maximum receive queue for TCP socket. */
-/*
+/* Define the maximum receive queue for TCP socket. The HTTP server advertises a 2 KB window
+   (NX_HTTP_SERVER_WINDOW_SIZE), so a peer never has more than two full-size segments in flight
+   and an /upload stream stays window-bound, not queue-bound. 8 also absorbs bursts of small
+   segments. The main packet pool is sized for exactly one such queue on top of its reserve. */
 #ifdef NX_ENABLE_LOW_WATERMARK
-#define NX_TCP_MAXIMUM_RX_QUEUE    20
+#define NX_TCP_MAXIMUM_RX_QUEUE    8
 #endif
-*/
 
 /* Configuration options for fragmentation */
 
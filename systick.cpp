@@ -25,10 +25,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <inttypes.h>
 #include <stdio.h>
 
-#include "./artnet.h"
-#include "./control.h"
 #include "./model.h"
-#include "./random.h"
 #include "./sacn.h"
 #include "./strip.h"
 #include "stm32h5xx_hal.h"
@@ -55,6 +52,10 @@ static uint64_t large_dwt_cyccnt() {
     static uint32_t PREV_DWT_CYCCNT = 0;
     static uint64_t LARGE_DWT_CYCCNT = 0;
 
+    // Threads and the SysTick handler both extend the counter; an interrupted update would count a wrap twice
+    const uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
     static bool init = false;
     if (!init) {
         init = true;
@@ -71,23 +72,11 @@ static uint64_t large_dwt_cyccnt() {
 
     PREV_DWT_CYCCNT = CURRENT_DWT_CYCCNT;
 
-    return LARGE_DWT_CYCCNT + CURRENT_DWT_CYCCNT;
+    const uint64_t result = LARGE_DWT_CYCCNT + CURRENT_DWT_CYCCNT;
+    __set_PRIMASK(primask);
+    return result;
 }
 
-#ifndef BOOTLOADER
-
-void Systick::schedulePollReply(const NXD_ADDRESS *from, uint16_t universe) {
-    for (int32_t c = 0; c < 8; c++) {
-        if (pollReply[c].delay <= 0) {
-            pollReply[c].from = *from;
-            pollReply[c].universe = universe;
-            pollReply[c].delay = PseudoRandom::instance().get(1000, 9000);
-            return;
-        }
-    }
-}
-#endif  // #ifndef BOOTLOADER
-
 void Systick::handler() {
     if (!started) {
         return;
@@ -96,31 +85,6 @@ void Systick::handler() {
     // Handle wrap around if required
     large_dwt_cyccnt();
 
-#ifndef BOOTLOADER
-
-    static uint32_t set_color = 1;
-    if ((set_color++ & 0x0000'0FFF) == 0x0 && !Control::instance().dataReceived()) {
-        Control::instance().scheduleColor();
-    }
-
-    static uint32_t sacn_discovery = 1;
-    if ((sacn_discovery++ & 0x0003'FFFF) == 0x0) {
-        sACNPacket::sendDiscovery();
-    }
-
-    for (int32_t c = 0; c < 8; c++) {
-        if (pollReply[c].delay > 0) {
-            pollReply[c].delay--;
-            if (pollReply[c].delay <= 0) {
-                ArtNetPacket::sendArtPollReply(&pollReply[c].from, pollReply[c].universe);
-                pollReply[c].from = NXD_ADDRESS{};
-                pollReply[c].universe = 0;
-            }
-        }
-    }
-
-#endif  // #ifndef BOOTLOADER
-
 #if 0
     static uint32_t status_led = 0;
     if ((status_led++ & 0xF) == 0x0) {
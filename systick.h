@@ -34,12 +34,17 @@ class Systick {
     Systick() {}
     static Systick &instance();
 
+    // DWT cycles since boot. Compare times with the helpers below; they work on differences, so they survive a wrap.
     uint64_t systemTimeRAW() const;
-    double systemTime() const { return double(systemTimeRAW()) / double(SystemCoreClock); }
+    // Wraps after ~49 days, only meant for animation phases
+    uint32_t systemTimeMS() const { return uint32_t(systemTimeRAW() / cyclesPerMS()); }
+    // Position within a repeating period as a 0.16 fraction
+    uint32_t phase(uint32_t period_ms) const { return uint32_t((uint64_t(systemTimeMS() % period_ms) << 16) / period_ms); }
 
-#ifndef BOOTLOADER
-    void schedulePollReply(const NXD_ADDRESS *from, uint16_t universe);
-#endif  // #ifndef BOOTLOADER
+    static uint64_t cyclesPerMS() { return SystemCoreClock / 1000; }
+    static uint64_t msToCycles(uint32_t ms) { return uint64_t(ms) * cyclesPerMS(); }
+    static bool elapsed(uint64_t now, uint64_t since, uint64_t period) { return (now - since) > period; }
+    static bool reached(uint64_t now, uint64_t deadline) { return int64_t(now - deadline) >= 0; }
 
     void handler();
 
@@ -57,14 +62,6 @@ class Systick {
 
     int32_t resetCount = 0;
     bool started = false;
-
-#ifndef BOOTLOADER
-    struct {
-        NXD_ADDRESS from;
-        uint16_t universe;
-        int32_t delay;
-    } pollReply[8] {};
-#endif  // #ifndef BOOTLOADER
 };
 
 #endif  // #ifndef SYSTICK_H
\ No newline at end of file
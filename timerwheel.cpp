@@ -0,0 +1,237 @@
+/*
+Copyright 2023 Tinic Uro
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "./timerwheel.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+
+#include "./artnet.h"
+#include "./control.h"
+#include "./network.h"
+#include "./sacn.h"
+#include "./utils.h"
+
+#ifndef BOOTLOADER
+
+static constexpr uint32_t colorInterval = 0x0000'1000;
+static constexpr uint32_t discoveryInterval = 0x0004'0000;
+static constexpr uint32_t timeoutInterval = TX_TIMER_TICKS_PER_SECOND;
+
+static TimerWheel::Timer colorTimer{[](void *) {
+    if (!Control::instance().dataReceived()) {
+        Network::instance().scheduleColor();
+    }
+}};
+static TimerWheel::Timer discoveryTimer{[](void *) { sACNPacket::sendDiscovery(); }};
+static TimerWheel::Timer timeoutTimer{[](void *) { Network::instance().scheduleTimeouts(); }};
+
+static void thread_service_entry(ULONG thread_input) {
+    NX_PARAMETER_NOT_USED(thread_input);
+    TimerWheel::instance().thread();
+}
+
+TimerWheel &TimerWheel::instance() {
+    static TimerWheel wheel;
+    if (!wheel.initialized) {
+        wheel.initialized = true;
+        wheel.init();
+    }
+    return wheel;
+}
+
+void TimerWheel::init() {}
+
+uint8_t *TimerWheel::setup(uint8_t *pointer) {
+    const size_t service_stack_size = 4096;
+    tx_mutex_create(&lock, const_cast<CHAR *>("timerwheel"), TX_INHERIT);
+    tx_event_flags_create(&wake, const_cast<CHAR *>("timerwheel"));
+    tx_thread_create(&thread_service, const_cast<CHAR *>("service"), thread_service_entry, 0, pointer, service_stack_size, NX_SERVICE_THREAD_PRIORITY,
+                     NX_SERVICE_THREAD_PRIORITY, TX_NO_TIME_SLICE, TX_DONT_START);
+    pointer = pointer + service_stack_size;
+    base = uint32_t(tx_time_get());
+    return pointer;
+}
+
+void TimerWheel::start() {
+    add(colorTimer, colorInterval, colorInterval);
+    add(discoveryTimer, discoveryInterval, discoveryInterval);
+    add(timeoutTimer, timeoutInterval, timeoutInterval);
+    tx_thread_resume(&thread_service);
+}
+
+void TimerWheel::insert(Timer &timer) {
+    // Already due timers go into the slot processed next
+    uint32_t delta = timer.expires - base;
+    if (int32_t(delta) < 0) {
+        timer.expires = base;
+        delta = 0;
+    }
+    Timer **slot = nullptr;
+    if (delta < level0N) {
+        slot = &level0[timer.expires & (level0N - 1)];
+    } else {
+        size_t level = 0;
+        size_t shift = level0Bits;
+        while (level + 1 < upperLevelN && delta >= (1UL << (shift + levelNBits))) {
+            level++;
+            shift += levelNBits;
+        }
+        // Beyond the wheel's reach: park in the farthest slot, cascading files it again
+        if (delta >= (1UL << (shift + levelNBits))) {
+            slot = &levelN[level][((base >> shift) - 1) & (levelNN - 1)];
+        } else {
+            slot = &levelN[level][(timer.expires >> shift) & (levelNN - 1)];
+        }
+    }
+    timer.next = *slot;
+    if (timer.next) {
+        timer.next->pprev = &timer.next;
+    }
+    timer.pprev = slot;
+    *slot = &timer;
+    timer.armed = true;
+}
+
+void TimerWheel::unlink(Timer &timer) {
+    if (!timer.armed) {
+        return;
+    }
+    *timer.pprev = timer.next;
+    if (timer.next) {
+        timer.next->pprev = timer.pprev;
+    }
+    timer.next = nullptr;
+    timer.pprev = nullptr;
+    timer.armed = false;
+}
+
+void TimerWheel::add(Timer &timer, uint32_t delay, uint32_t period) {
+    tx_mutex_get(&lock, TX_WAIT_FOREVER);
+    unlink(timer);
+    timer.period = period;
+    timer.expires = uint32_t(tx_time_get()) + delay;
+    insert(timer);
+    tx_mutex_put(&lock);
+    tx_event_flags_set(&wake, wakeFlag, TX_OR);
+}
+
+bool TimerWheel::arm(Timer &timer, uint32_t delay) {
+    tx_mutex_get(&lock, TX_WAIT_FOREVER);
+    const bool armed = timer.armed;
+    if (!armed) {
+        timer.period = 0;
+        timer.expires = uint32_t(tx_time_get()) + delay;
+        insert(timer);
+    }
+    tx_mutex_put(&lock);
+    if (!armed) {
+        tx_event_flags_set(&wake, wakeFlag, TX_OR);
+    }
+    return !armed;
+}
+
+void TimerWheel::cancel(Timer &timer) {
+    tx_mutex_get(&lock, TX_WAIT_FOREVER);
+    unlink(timer);
+    tx_mutex_put(&lock);
+}
+
+void TimerWheel::cascade(size_t level, size_t index) {
+    Timer *timer = levelN[level][index];
+    levelN[level][index] = nullptr;
+    while (timer) {
+        Timer *next = timer->next;
+        insert(*timer);
+        timer = next;
+    }
+}
+
+void TimerWheel::advance() {
+    // Moves the timers of every tick up to now onto the pending list; they stay linked so add() and cancel() keep working
+    const uint32_t now = uint32_t(tx_time_get());
+    while (int32_t(now - base) >= 0) {
+        const size_t index = base & (level0N - 1);
+        if (index == 0) {
+            size_t shift = level0Bits;
+            for (size_t level = 0; level < upperLevelN; level++, shift += levelNBits) {
+                const size_t upper = (base >> shift) & (levelNN - 1);
+                cascade(level, upper);
+                if (upper != 0) {
+                    break;
+                }
+            }
+        }
+        Timer *timer = level0[index];
+        level0[index] = nullptr;
+        while (timer) {
+            Timer *next = timer->next;
+            timer->next = pending;
+            if (pending) {
+                pending->pprev = &timer->next;
+            }
+            timer->pprev = &pending;
+            pending = timer;
+            timer = next;
+        }
+        base++;
+    }
+}
+
+ULONG TimerWheel::idleTicks() const {
+    // Sleep until the next occupied slot, or the next cascade when the near wheel is empty
+    const uint32_t now = uint32_t(tx_time_get());
+    for (uint32_t c = 0; c < level0N; c++) {
+        const uint32_t tick = base + c;
+        if ((tick & (level0N - 1)) == 0 || level0[tick & (level0N - 1)]) {
+            return ULONG(std::max(int32_t(tick - now), int32_t(1)));
+        }
+    }
+    return level0N;
+}
+
+void TimerWheel::thread() {
+    while (1) {
+        tx_mutex_get(&lock, TX_WAIT_FOREVER);
+        advance();
+        while (pending) {
+            Timer *timer = pending;
+            unlink(*timer);
+            if (timer->period) {
+                timer->expires += timer->period;
+                insert(*timer);
+            }
+            // Callbacks run unlocked so they can re-arm themselves or others
+            tx_mutex_put(&lock);
+            timer->callback(timer->user);
+            tx_mutex_get(&lock, TX_WAIT_FOREVER);
+        }
+        const ULONG wait = idleTicks();
+        tx_mutex_put(&lock);
+
+        ULONG flags = 0;
+        tx_event_flags_get(&wake, wakeFlag, TX_OR_CLEAR, &flags, wait);
+    }
+}
+
+#endif  // #ifndef BOOTLOADER
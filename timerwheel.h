@@ -0,0 +1,93 @@
+/*
+Copyright 2023 Tinic Uro
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#ifndef _TIMERWHEEL_H_
+#define _TIMERWHEEL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <array>
+
+#include "tx_api.h"
+
+#ifndef BOOTLOADER
+
+// Hierarchical timer wheel in ThreadX ticks. Timers fire on the service thread, never in interrupt context, so callbacks
+// may block, allocate packets and touch flash.
+class TimerWheel {
+   public:
+    typedef void (*Callback)(void *user);
+
+    struct Timer {
+        Callback callback = nullptr;
+        void *user = nullptr;
+        uint32_t period = 0;
+        uint32_t expires = 0;
+        Timer *next = nullptr;
+        Timer **pprev = nullptr;
+        bool armed = false;
+    };
+
+    static TimerWheel &instance();
+
+    uint8_t *setup(uint8_t *pointer);
+    void start();
+
+    // (Re)arms timer to fire after delay ticks and then every period ticks if period is non-zero
+    void add(Timer &timer, uint32_t delay, uint32_t period = 0);
+    // Arms timer only if it is not pending already; returns false if it was
+    bool arm(Timer &timer, uint32_t delay);
+    void cancel(Timer &timer);
+
+    void thread();
+
+   private:
+    static constexpr size_t level0Bits = 8;
+    static constexpr size_t levelNBits = 6;
+    static constexpr size_t level0N = 1UL << level0Bits;
+    static constexpr size_t levelNN = 1UL << levelNBits;
+    static constexpr size_t upperLevelN = 2;
+    static constexpr ULONG wakeFlag = 0x1;
+
+    void insert(Timer &timer);
+    void unlink(Timer &timer);
+    void cascade(size_t level, size_t index);
+    void advance();
+    ULONG idleTicks() const;
+
+    std::array<Timer *, level0N> level0{};
+    std::array<std::array<Timer *, levelNN>, upperLevelN> levelN{};
+    Timer *pending = nullptr;
+    uint32_t base = 0;
+
+    bool initialized = false;
+    void init();
+
+    TX_MUTEX lock{};
+    TX_EVENT_FLAGS_GROUP wake{};
+    TX_THREAD thread_service{};
+};
+
+#endif  // #ifndef BOOTLOADER
+
+#endif  // #ifndef _TIMERWHEEL_H_
@@ -71,6 +71,9 @@ UINT WebServer::requestNotifyCallback(NX_HTTP_SERVER *server_ptr, UINT request_t
 }
 
 UINT WebServer::requestNotify(NX_HTTP_SERVER *server_ptr, UINT request_type, const CHAR *resource, NX_PACKET *packet_ptr) {
+#ifndef BOOTLOADER
+    Network::instance().samplePools();
+#endif  // #ifndef BOOTLOADER
     switch (request_type) {
         case NX_HTTP_SERVER_GET_REQUEST: {
             if (strcmp(resource, "/") == 0) {